@@ -15,6 +15,7 @@ DEFINES += DEBUG_SERENITY
 
 DEFINES += CT_TRACE
 //DEFINES += CT_DETERMINISTIC
+//DEFINES += CT_MEMBER_FUNCTION_DISPATCH
 CONFIG += silent
 CONFIG += debug
 QT += widgets
@@ -24,7 +25,6 @@ CONFIG -= app_bundle
 unix {
     LIBS += -lreadline
     DEFINES += HAVE_READLINE
-    DEFINES += HAVE_USLEEP
 }
 
 OBJECTS_DIR = .obj
@@ -61,7 +61,7 @@ HEADERS += gui/machinewidget.h \
            hw/PS2.h \
            hw/busmouse.h \
            hw/MouseObserver.h \
-           hw/ThreadedTimer.h \
+           hw/EventScheduler.h \
            include/debugger.h \
            include/types.h \
            include/debug.h \
@@ -72,7 +72,11 @@ HEADERS += gui/machinewidget.h \
            include/OwnPtr.h \
            x86/CPU.h \
            x86/Descriptor.h \
+           x86/DescriptorCache.h \
+           x86/DirtyPageBitmap.h \
            x86/Instruction.h \
+           x86/InstructionCache.h \
+           x86/TLB.h \
            x86/Tasking.h
 
 SOURCES += debug.cpp \
@@ -85,9 +89,12 @@ SOURCES += debug.cpp \
            x86/bitwise.cpp \
            x86/CPU.cpp \
            x86/Descriptor.cpp \
+           x86/DescriptorCache.cpp \
+           x86/DirtyPageBitmap.cpp \
            x86/flags.cpp \
            x86/fpu.cpp \
            x86/Instruction.cpp \
+           x86/InstructionCache.cpp \
            x86/interrupt.cpp \
            x86/io.cpp \
            x86/jump.cpp \
@@ -95,6 +102,7 @@ SOURCES += debug.cpp \
            x86/modrm.cpp \
            x86/mov.cpp \
            x86/pmode.cpp \
+           x86/SaveState.cpp \
            x86/stack.cpp \
            x86/string.cpp \
            x86/Tasking.cpp \
@@ -122,4 +130,4 @@ SOURCES += debug.cpp \
            hw/SimpleMemoryProvider.cpp \
            hw/DiskDrive.cpp \
            hw/MouseObserver.cpp \
-           hw/ThreadedTimer.cpp
+           hw/EventScheduler.cpp
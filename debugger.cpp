@@ -173,6 +173,12 @@ void Debugger::handleCommand(const QString& rawCommand)
     if (lowerCommand == "k" || lowerCommand == "stack")
         return handleStack(arguments);
 
+    if (lowerCommand == "save-state")
+        return handleSaveState(arguments);
+
+    if (lowerCommand == "restore-state")
+        return handleRestoreState(arguments);
+
     if (lowerCommand == "gdt") {
         cpu().dumpGDT();
         return;
@@ -415,6 +421,25 @@ void Debugger::handleStack(const QStringList& arguments)
     cpu().dumpStack(DWordSize, 16);
 }
 
+void Debugger::handleSaveState(const QStringList& arguments)
+{
+    if (arguments.size() != 1) {
+        printf("usage: save-state <filename>\n");
+        return;
+    }
+    cpu().machine().saveState(arguments.at(0));
+}
+
+void Debugger::handleRestoreState(const QStringList& arguments)
+{
+    if (arguments.size() != 1) {
+        printf("usage: restore-state <filename>\n");
+        return;
+    }
+    if (cpu().machine().restoreState(arguments.at(0)))
+        cpu().dumpAll();
+}
+
 void Debugger::handleDumpMemory(const QStringList& arguments)
 {
     WORD selector = cpu().getCS();
@@ -140,6 +140,8 @@ void parseArguments(const QStringList& arguments)
             options.novlog = true;
         else if (argument == "--no-log-exceptions")
             options.log_exceptions = false;
+        else if (argument == "--benchmark")
+            options.benchmark = true;
         else if (argument == "--config") {
             ++it;
             if (it == arguments.end()) {
@@ -149,6 +151,26 @@ void parseArguments(const QStringList& arguments)
             options.configPath = (*it);
             continue;
         }
+        else if (argument == "--restore-state") {
+            ++it;
+            if (it == arguments.end()) {
+                fprintf(stderr, "usage: computron --restore-state [filename]\n");
+                hard_exit(1);
+            }
+            options.restoreStatePath = (*it);
+            continue;
+        }
+        else if (argument == "--virtual-clock") {
+            ++it;
+            bool ok = false;
+            if (it != arguments.end())
+                options.virtualClockMHz = (*it).toUInt(&ok);
+            if (!ok || !options.virtualClockMHz) {
+                fprintf(stderr, "usage: computron --virtual-clock [MHz]\n");
+                hard_exit(1);
+            }
+            continue;
+        }
         else if (argument == "--run") {
             ++it;
             if (it == arguments.end()) {
@@ -161,6 +183,11 @@ void parseArguments(const QStringList& arguments)
         ++it;
     }
 
+#ifdef CT_DETERMINISTIC
+    if (!options.virtualClockMHz)
+        options.virtualClockMHz = 100;
+#endif
+
 #ifndef CT_TRACE
     if (options.trace) {
         fprintf(stderr, "Rebuild with #define CT_TRACE if you want --trace to work.\n");
@@ -0,0 +1,102 @@
+// Computron x86 PC Emulator
+// Copyright (C) 2003-2018 Andreas Kling <awesomekling@gmail.com>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY ANDREAS KLING ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANDREAS KLING OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "EventScheduler.h"
+#include "debug.h"
+#include <algorithm>
+
+EventScheduler::EventScheduler()
+{
+    m_clock.start();
+}
+
+QWORD EventScheduler::now() const
+{
+    if (!m_cycleCounter)
+        return m_clock.nsecsElapsed();
+    return m_nanosecondOrigin + (*m_cycleCounter - m_cycleOrigin) * 1000 / m_cyclesPerMicrosecond;
+}
+
+QDateTime EventScheduler::currentDateTime() const
+{
+    if (!m_cycleCounter)
+        return QDateTime::currentDateTime();
+    // Virtual time always starts at the same moment.
+    static const QDateTime epoch(QDate(2018, 2, 9), QTime(1, 2, 3, 4));
+    return epoch.addMSecs(now() / 1000000);
+}
+
+void EventScheduler::setVirtualClock(const QWORD* cycleCounter, unsigned cyclesPerMicrosecond)
+{
+    ASSERT(cyclesPerMicrosecond);
+    m_nanosecondOrigin = now();
+    m_cycleCounter = cycleCounter;
+    m_cyclesPerMicrosecond = cyclesPerMicrosecond;
+    m_cycleOrigin = *cycleCounter;
+}
+
+void EventScheduler::rebaseVirtualClock(QWORD newCycleCount)
+{
+    if (!m_cycleCounter)
+        return;
+    m_nanosecondOrigin = now();
+    m_cycleOrigin = newCycleCount;
+}
+
+QWORD EventScheduler::virtualCycleForDeadline(QWORD deadline) const
+{
+    ASSERT(m_cycleCounter);
+    if (deadline <= m_nanosecondOrigin)
+        return m_cycleOrigin;
+    return m_cycleOrigin + ((deadline - m_nanosecondOrigin) * m_cyclesPerMicrosecond + 999) / 1000;
+}
+
+EventScheduler::EventID EventScheduler::scheduleAt(QWORD deadline, Callback callback)
+{
+    EventID id = m_nextID++;
+    m_callbacks.insert(id, std::move(callback));
+    m_queue.push_back({ deadline, id });
+    std::push_heap(m_queue.begin(), m_queue.end());
+    return id;
+}
+
+void EventScheduler::cancel(EventID id)
+{
+    m_callbacks.remove(id);
+}
+
+void EventScheduler::runExpiredEvents()
+{
+    QWORD currentTime = now();
+    while (!m_queue.empty() && m_queue.front().deadline <= currentTime) {
+        EventID id = m_queue.front().id;
+        std::pop_heap(m_queue.begin(), m_queue.end());
+        m_queue.pop_back();
+
+        Callback callback = m_callbacks.take(id);
+        if (callback)
+            callback();
+    }
+}
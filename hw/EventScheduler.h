@@ -0,0 +1,90 @@
+// Computron x86 PC Emulator
+// Copyright (C) 2003-2018 Andreas Kling <awesomekling@gmail.com>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY ANDREAS KLING ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANDREAS KLING OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#pragma once
+
+#include "types.h"
+#include <QtCore/QDateTime>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <functional>
+#include <vector>
+
+// Timed device events, kept in a min-heap ordered by deadline on the machine clock.
+//
+// Everything here happens on the CPU thread: devices schedule callbacks, and the CPU runs
+// the ones that are due between basic blocks, or sleeps until the next one while halted.
+// Periodic events are simply rescheduled from their own callback.
+//
+// With a virtual clock, time is derived from the CPU cycle counter at a nominal clock rate
+// instead of the host clock, so guest-visible timing is the same from one run to the next.
+class EventScheduler {
+public:
+    typedef unsigned EventID;
+    typedef std::function<void()> Callback;
+
+    static const QWORD noDeadline = ~0ull;
+
+    EventScheduler();
+
+    // Nanoseconds since the scheduler was created.
+    QWORD now() const;
+
+    // Wall-clock time as the guest should see it.
+    QDateTime currentDateTime() const;
+
+    void setVirtualClock(const QWORD* cycleCounter, unsigned cyclesPerMicrosecond);
+    bool hasVirtualClock() const { return m_cycleCounter; }
+    // Call before the cycle counter is set to a new value, so virtual time keeps moving forward.
+    void rebaseVirtualClock(QWORD newCycleCount);
+    // The cycle count at which virtual time reaches the given deadline.
+    QWORD virtualCycleForDeadline(QWORD deadline) const;
+
+    EventID schedule(QWORD delayNanoseconds, Callback callback) { return scheduleAt(now() + delayNanoseconds, std::move(callback)); }
+    EventID scheduleAt(QWORD deadline, Callback);
+    void cancel(EventID);
+
+    QWORD nextDeadline() const { return m_queue.empty() ? noDeadline : m_queue.front().deadline; }
+    void runExpiredEvents();
+
+private:
+    struct QueuedEvent {
+        QWORD deadline;
+        EventID id;
+        bool operator<(const QueuedEvent& other) const { return deadline > other.deadline; }
+    };
+
+    QElapsedTimer m_clock;
+
+    const QWORD* m_cycleCounter { nullptr };
+    unsigned m_cyclesPerMicrosecond { 0 };
+    QWORD m_cycleOrigin { 0 };
+    QWORD m_nanosecondOrigin { 0 };
+
+    std::vector<QueuedEvent> m_queue;
+    // Cancelled events stay in the queue, but lose their callback.
+    QHash<EventID, Callback> m_callbacks;
+    EventID m_nextID { 1 };
+};
@@ -63,6 +63,7 @@ DWORD MemoryProvider::readMemory32(DWORD address)
 
 void MemoryProvider::setSize(DWORD size)
 {
-    RELEASE_ASSERT((size % 16384) == 0);
+    // Providers are mapped into the physical address space a page at a time.
+    RELEASE_ASSERT((size % 4096) == 0);
     m_size = size;
 }
@@ -45,6 +45,9 @@ public:
     virtual void writeMemory32(DWORD address, DWORD);
 
     const BYTE* pointerForDirectReadAccess() const { return m_pointerForDirectReadAccess; }
+    // Providers whose memory can be stored to without side effects. When both are set,
+    // the direct read and write pointers refer to the same memory.
+    BYTE* pointerForDirectWriteAccess() const { return m_pointerForDirectWriteAccess; }
 
     template<typename T> T read(DWORD address);
     template<typename T> void write(DWORD address, T);
@@ -53,6 +56,7 @@ protected:
     MemoryProvider(PhysicalAddress baseAddress, DWORD size = 0) : m_baseAddress(baseAddress) { setSize(size); }
     void setSize(DWORD);
     const BYTE* m_pointerForDirectReadAccess { nullptr };
+    BYTE* m_pointerForDirectWriteAccess { nullptr };
 
 private:
     PhysicalAddress m_baseAddress;
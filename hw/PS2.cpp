@@ -26,6 +26,7 @@
 #include "Common.h"
 #include "CPU.h"
 #include "machine.h"
+#include <QtCore/QDataStream>
 
 //#define PS2_DEBUG
 
@@ -45,6 +46,17 @@ void PS2::reset()
     machine().cpu().setA20Enabled(false);
 }
 
+// A20 itself is part of the CPU state.
+void PS2::saveState(QDataStream& stream) const
+{
+    stream << m_controlPortA;
+}
+
+void PS2::restoreState(QDataStream& stream)
+{
+    stream >> m_controlPortA;
+}
+
 BYTE PS2::in8(WORD port)
 {
     if (port == 0x92) {
@@ -62,8 +74,12 @@ void PS2::out8(WORD port, BYTE data)
 #ifdef PS2_DEBUG
         vlog(LogIO, "A20=%u->%u (System Control Port A)", machine().cpu().isA20Enabled(), !!(data & 0x2));
 #endif
+        // Bit 0 resets the machine on a 0->1 transition, not whenever it's written as 1.
+        bool fastReset = (data & 0x1) && !(m_controlPortA & 0x1);
         m_controlPortA = data;
         machine().cpu().setA20Enabled(data & 0x2);
+        if (fastReset)
+            machine().cpu().queueCommand(CPU::HardReboot);
         return;
     }
     IODevice::out8(port, data);
@@ -50,20 +50,53 @@ bool ROM::isValid() const
     return !m_data.isNull();
 }
 
+template<typename T>
+T ROM::readData(DWORD address) const
+{
+    T data;
+    memcpy(&data, &m_data.constData()[address - baseAddress().get()], sizeof(T));
+    return data;
+}
+
 BYTE ROM::readMemory8(DWORD address)
 {
-    return m_data.data()[address - baseAddress().get()];
+    return readData<BYTE>(address);
 }
 
-void ROM::writeMemory8(DWORD address, BYTE data)
+WORD ROM::readMemory16(DWORD address)
+{
+    return readData<WORD>(address);
+}
+
+DWORD ROM::readMemory32(DWORD address)
+{
+    return readData<DWORD>(address);
+}
+
+void ROM::didWrite(DWORD address, DWORD data, int size)
 {
-    vlog(LogAlert, "Write to ROM address %08x, data %02x", address, data);
+    vlog(LogAlert, "Write to ROM address %08x, data %0*x", address, size * 2, data);
 #ifdef DEBUG_SERENITY
     if (options.serenity)
         g_cpu->debugger().enter();
 #endif
 }
 
+void ROM::writeMemory8(DWORD address, BYTE data)
+{
+    didWrite(address, data, 1);
+}
+
+void ROM::writeMemory16(DWORD address, WORD data)
+{
+    didWrite(address, data, 2);
+}
+
+void ROM::writeMemory32(DWORD address, DWORD data)
+{
+    didWrite(address, data, 4);
+}
+
 const BYTE* ROM::memoryPointer(DWORD address) const
 {
     return reinterpret_cast<const BYTE*>(&m_data.data()[address - baseAddress().get()]);
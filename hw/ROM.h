@@ -36,8 +36,15 @@ public:
 
     virtual const BYTE* memoryPointer(DWORD address) const override;
     virtual BYTE readMemory8(DWORD address) override;
+    virtual WORD readMemory16(DWORD address) override;
+    virtual DWORD readMemory32(DWORD address) override;
     virtual void writeMemory8(DWORD address, BYTE) override;
+    virtual void writeMemory16(DWORD address, WORD) override;
+    virtual void writeMemory32(DWORD address, DWORD) override;
 
 private:
+    template<typename T> T readData(DWORD address) const;
+    void didWrite(DWORD address, DWORD data, int size);
+
     QByteArray m_data;
 };
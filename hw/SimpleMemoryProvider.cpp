@@ -32,20 +32,55 @@ SimpleMemoryProvider::SimpleMemoryProvider(PhysicalAddress baseAddress, DWORD si
     setSize(size);
     if (allowDirectReadAccess)
         m_pointerForDirectReadAccess = reinterpret_cast<const BYTE*>(m_data.data());
+    m_pointerForDirectWriteAccess = reinterpret_cast<BYTE*>(m_data.data());
 }
 
 SimpleMemoryProvider::~SimpleMemoryProvider()
 {
 }
 
+template<typename T>
+T SimpleMemoryProvider::readData(DWORD address) const
+{
+    T data;
+    memcpy(&data, &m_data.constData()[address - baseAddress().get()], sizeof(T));
+    return data;
+}
+
+template<typename T>
+void SimpleMemoryProvider::writeData(DWORD address, T data)
+{
+    memcpy(&m_data.data()[address - baseAddress().get()], &data, sizeof(T));
+}
+
 BYTE SimpleMemoryProvider::readMemory8(DWORD address)
 {
-    return m_data.data()[address - baseAddress().get()];
+    return readData<BYTE>(address);
+}
+
+WORD SimpleMemoryProvider::readMemory16(DWORD address)
+{
+    return readData<WORD>(address);
+}
+
+DWORD SimpleMemoryProvider::readMemory32(DWORD address)
+{
+    return readData<DWORD>(address);
 }
 
 void SimpleMemoryProvider::writeMemory8(DWORD address, BYTE data)
 {
-    m_data.data()[address - baseAddress().get()] = data;
+    writeData(address, data);
+}
+
+void SimpleMemoryProvider::writeMemory16(DWORD address, WORD data)
+{
+    writeData(address, data);
+}
+
+void SimpleMemoryProvider::writeMemory32(DWORD address, DWORD data)
+{
+    writeData(address, data);
 }
 
 const BYTE* SimpleMemoryProvider::memoryPointer(DWORD address) const
@@ -28,6 +28,7 @@
 #include "Common.h"
 #include "CPU.h"
 #include "debug.h"
+#include <QtCore/QDataStream>
 #include <QtCore/QMutexLocker>
 
 BusMouse::BusMouse(Machine& machine)
@@ -57,6 +58,20 @@ void BusMouse::reset()
     m_deltaY = 0;
 }
 
+void BusMouse::saveState(QDataStream& stream) const
+{
+    QMutexLocker locker(&m_mutex);
+    stream << m_interrupts << m_command << m_buttons;
+    stream << m_currentX << m_currentY << m_lastX << m_lastY << m_deltaX << m_deltaY;
+}
+
+void BusMouse::restoreState(QDataStream& stream)
+{
+    QMutexLocker locker(&m_mutex);
+    stream >> m_interrupts >> m_command >> m_buttons;
+    stream >> m_currentX >> m_currentY >> m_lastX >> m_lastY >> m_deltaX >> m_deltaY;
+}
+
 void BusMouse::out8(WORD port, BYTE data)
 {
     switch (port) {
@@ -34,6 +34,8 @@ public:
     virtual ~BusMouse() override;
 
     virtual void reset() override;
+    virtual void saveState(QDataStream&) const override;
+    virtual void restoreState(QDataStream&) override;
     virtual void out8(WORD port, BYTE data) override;
     virtual BYTE in8(WORD port) override;
 
@@ -55,5 +57,5 @@ private:
     WORD m_deltaX { 0 };
     WORD m_deltaY { 0 };
 
-    QMutex m_mutex;
+    mutable QMutex m_mutex;
 };
@@ -27,6 +27,7 @@
 #include "CPU.h"
 #include "machine.h"
 #include "DiskDrive.h"
+#include <QtCore/QDataStream>
 #include <QtCore/QDate>
 #include <QtCore/QTime>
 
@@ -35,14 +36,15 @@
 CMOS::CMOS(Machine& machine)
     : IODevice("CMOS", machine)
 {
-    m_rtcTimer = make<ThreadedTimer>(*this, 250);
     listen(0x70, IODevice::WriteOnly);
     listen(0x71, IODevice::ReadWrite);
     reset();
+    scheduleClockUpdate();
 }
 
 CMOS::~CMOS()
 {
+    machine().scheduler().cancel(m_clockUpdateEvent);
 }
 
 void CMOS::reset()
@@ -70,6 +72,20 @@ void CMOS::reset()
     updateClock();
 }
 
+void CMOS::saveState(QDataStream& stream) const
+{
+    stream << m_registerIndex;
+    stream.writeRawData(reinterpret_cast<const char*>(m_ram), sizeof(m_ram));
+}
+
+// The clock registers are brought up to date rather than restored to the time of saving.
+void CMOS::restoreState(QDataStream& stream)
+{
+    stream >> m_registerIndex;
+    stream.readRawData(reinterpret_cast<char*>(m_ram), sizeof(m_ram));
+    updateClock();
+}
+
 bool CMOS::inBinaryClockMode() const
 {
     return m_ram[StatusRegisterB] & 0x04;
@@ -80,14 +96,6 @@ bool CMOS::in24HourMode() const
     return m_ram[StatusRegisterB] & 0x02;
 }
 
-static QDateTime currentDateTimeForCMOS()
-{
-#ifdef CT_DETERMINISTIC
-    return QDateTime(QDate(2018, 2, 9), QTime(1, 2, 3, 4));
-#endif
-    return QDateTime::currentDateTime();
-}
-
 BYTE CMOS::toCurrentClockFormat(BYTE value) const
 {
     if (inBinaryClockMode())
@@ -101,7 +109,7 @@ void CMOS::updateClock()
     ASSERT(in24HourMode());
 
     m_ram[StatusRegisterA] |= 0x80; // RTC update in progress
-    auto now = currentDateTimeForCMOS();
+    auto now = machine().scheduler().currentDateTime();
     m_ram[RTCSecond] = toCurrentClockFormat(now.time().second());
     m_ram[RTCMinute] = toCurrentClockFormat(now.time().minute());
     m_ram[RTCHour] = toCurrentClockFormat(now.time().hour());
@@ -151,7 +159,10 @@ BYTE CMOS::get(RegisterIndex index) const
     return m_ram[index];
 }
 
-void CMOS::threadedTimerFired(Badge<ThreadedTimer>)
+void CMOS::scheduleClockUpdate()
 {
-    updateClock();
+    m_clockUpdateEvent = machine().scheduler().schedule(250000000, [this] {
+        updateClock();
+        scheduleClockUpdate();
+    });
 }
@@ -26,10 +26,9 @@
 
 #include "iodevice.h"
 #include "Common.h"
-#include "ThreadedTimer.h"
-#include "OwnPtr.h"
+#include "EventScheduler.h"
 
-class CMOS final : public IODevice, public ThreadedTimer::Listener {
+class CMOS final : public IODevice {
 public:
     enum RegisterIndex {
         StatusRegisterA = 0x0a,
@@ -56,6 +55,8 @@ public:
     ~CMOS();
 
     void reset() override;
+    void saveState(QDataStream&) const override;
+    void restoreState(QDataStream&) override;
     void out8(WORD port, BYTE data) override;
     BYTE in8(WORD port) override;
 
@@ -65,7 +66,7 @@ public:
     BYTE get(RegisterIndex) const;
 
 private:
-    virtual void threadedTimerFired(Badge<ThreadedTimer>) override;
+    void scheduleClockUpdate();
 
     BYTE m_registerIndex { 0 };
     BYTE m_ram[80];
@@ -74,5 +75,5 @@ private:
     bool in24HourMode() const;
     BYTE toCurrentClockFormat(BYTE) const;
 
-    OwnPtr<ThreadedTimer> m_rtcTimer;
+    EventScheduler::EventID m_clockUpdateEvent { 0 };
 };
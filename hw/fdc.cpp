@@ -28,6 +28,7 @@
 #include "debug.h"
 #include "machine.h"
 #include "DiskDrive.h"
+#include <QtCore/QDataStream>
 
 #define FDC_NEC765
 #define FDC_DEBUG
@@ -214,6 +215,36 @@ void FDC::reset()
     resetController(ResetSource::Hardware);
 }
 
+void FDC::saveState(QDataStream& stream) const
+{
+    for (auto& drive : d->drive) {
+        stream << drive.motor << drive.cylinder << drive.head << drive.sector;
+        stream << drive.stepRateTime << drive.headLoadTime << drive.headUnloadTime << drive.bytesPerSector;
+        stream << drive.endOfTrack << drive.gap3Length << drive.dataLength << drive.digitalInputRegister;
+    }
+    stream << d->driveIndex << d->enabled << (quint8)d->dataRate << d->dataDirection << d->mainStatusRegister;
+    stream.writeRawData(reinterpret_cast<const char*>(d->statusRegister), sizeof(d->statusRegister));
+    stream << d->hasPendingReset << d->command << d->commandSize << d->commandResult;
+    stream << d->configureData << d->precompensationStartNumber << d->perpendicularModeConfig << d->lock;
+    stream << d->expectedSenseInterruptCount;
+}
+
+void FDC::restoreState(QDataStream& stream)
+{
+    for (auto& drive : d->drive) {
+        stream >> drive.motor >> drive.cylinder >> drive.head >> drive.sector;
+        stream >> drive.stepRateTime >> drive.headLoadTime >> drive.headUnloadTime >> drive.bytesPerSector;
+        stream >> drive.endOfTrack >> drive.gap3Length >> drive.dataLength >> drive.digitalInputRegister;
+    }
+    quint8 dataRate;
+    stream >> d->driveIndex >> d->enabled >> dataRate >> d->dataDirection >> d->mainStatusRegister;
+    d->dataRate = static_cast<FDCDataRate>(dataRate);
+    stream.readRawData(reinterpret_cast<char*>(d->statusRegister), sizeof(d->statusRegister));
+    stream >> d->hasPendingReset >> d->command >> d->commandSize >> d->commandResult;
+    stream >> d->configureData >> d->precompensationStartNumber >> d->perpendicularModeConfig >> d->lock;
+    stream >> d->expectedSenseInterruptCount;
+}
+
 BYTE FDC::in8(WORD port)
 {
     BYTE data = 0;
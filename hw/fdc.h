@@ -33,6 +33,8 @@ public:
     virtual ~FDC();
 
     virtual void reset() override;
+    virtual void saveState(QDataStream&) const override;
+    virtual void restoreState(QDataStream&) override;
     virtual BYTE in8(WORD port) override;
     virtual void out8(WORD port, BYTE data) override;
 
@@ -27,6 +27,7 @@
 #include "ide.h"
 #include "machine.h"
 #include "DiskDrive.h"
+#include <QtCore/QDataStream>
 
 //#define IDE_DEBUG
 
@@ -200,6 +201,27 @@ void IDE::reset()
      d->controller[1].drivePtr = &machine().fixed1();
 }
 
+// The drives behind the controllers come from the machine settings, not from the saved state.
+void IDE::saveState(QDataStream& stream) const
+{
+    for (auto& controller : d->controller) {
+        stream << controller.cylinderIndex << controller.sectorIndex << controller.headIndex << controller.sectorCount;
+        stream << controller.error << controller.inLBAMode;
+        stream << controller.m_readBuffer << (qint32)controller.m_readBufferIndex;
+        stream << controller.m_writeBuffer << (qint32)controller.m_writeBufferIndex;
+    }
+}
+
+void IDE::restoreState(QDataStream& stream)
+{
+    for (auto& controller : d->controller) {
+        stream >> controller.cylinderIndex >> controller.sectorIndex >> controller.headIndex >> controller.sectorCount;
+        stream >> controller.error >> controller.inLBAMode;
+        stream >> controller.m_readBuffer >> controller.m_readBufferIndex;
+        stream >> controller.m_writeBuffer >> controller.m_writeBufferIndex;
+    }
+}
+
 void IDE::out8(WORD port, BYTE data)
 {
 #ifdef IDE_DEBUG
@@ -47,6 +47,8 @@ public:
     virtual ~IDE();
 
     virtual void reset() override;
+    virtual void saveState(QDataStream&) const override;
+    virtual void restoreState(QDataStream&) override;
     virtual BYTE in8(WORD port) override;
     virtual WORD in16(WORD port) override;
     virtual DWORD in32(WORD port) override;
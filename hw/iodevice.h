@@ -29,6 +29,7 @@
 #include <QList>
 
 class Machine;
+class QDataStream;
 
 class IODevice {
 public:
@@ -44,6 +45,10 @@ public:
 
     virtual void reset() = 0;
 
+    // Device state for Machine::saveState(). restoreState() reads back exactly what saveState() wrote.
+    virtual void saveState(QDataStream&) const = 0;
+    virtual void restoreState(QDataStream&) = 0;
+
     template<typename T> T in(WORD port);
     template<typename T> void out(WORD port, T data);
 
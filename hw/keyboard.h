@@ -39,6 +39,8 @@ public:
     virtual ~Keyboard();
 
     virtual void reset() override;
+    virtual void saveState(QDataStream&) const override;
+    virtual void restoreState(QDataStream&) override;
     virtual BYTE in8(WORD port) override;
     virtual void out8(WORD port, BYTE data) override;
 
@@ -27,6 +27,7 @@
 #include "pic.h"
 #include "debug.h"
 #include "machine.h"
+#include <QtCore/QDataStream>
 
 //#define PIC_DEBUG
 
@@ -49,6 +50,9 @@ void PIC::updatePendingRequests(Machine& machine)
     WORD masterRequests = (machine.masterPIC().getIRR() & ~machine.masterPIC().getIMR());
     WORD slaveRequests = (machine.slavePIC().getIRR() & ~machine.slavePIC().getIMR());
     s_pendingRequests = masterRequests | (slaveRequests << 8);
+    machine.cpu().setPendingEvent(CPU::PendingIRQ, s_pendingRequests);
+    if (s_pendingRequests)
+        machine.cpu().wakeFromHalt();
 #ifdef PIC_DEBUG
     if (machine.cpu().state() != CPU::Halted)
         vlog(LogPIC, "Pending requests: %04x", (WORD)s_pendingRequests);
@@ -84,6 +88,19 @@ void PIC::reset()
     s_pendingRequests = 0;
 }
 
+void PIC::saveState(QDataStream& stream) const
+{
+    stream << m_isrBase << m_isr << m_irr << m_imr;
+    stream << m_icw2Expected << m_icw4Expected << m_readISR << m_specialMaskMode;
+}
+
+void PIC::restoreState(QDataStream& stream)
+{
+    stream >> m_isrBase >> m_isr >> m_irr >> m_imr;
+    stream >> m_icw2Expected >> m_icw4Expected >> m_readISR >> m_specialMaskMode;
+    updatePendingRequests(machine());
+}
+
 void PIC::dumpMask()
 {
     const char* green = "\033[32;1m";
@@ -35,6 +35,8 @@ public:
     ~PIC();
 
     virtual void reset() override;
+    virtual void saveState(QDataStream&) const override;
+    virtual void restoreState(QDataStream&) override;
     void out8(WORD port, BYTE data) override;
     BYTE in8(WORD port) override;
 
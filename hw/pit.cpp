@@ -26,36 +26,39 @@
 #include "debug.h"
 #include "pic.h"
 #include "pit.h"
-#include <math.h>
-#include <QElapsedTimer>
+#include "machine.h"
+#include "EventScheduler.h"
+#include <QtCore/QDataStream>
+#include <algorithm>
 
 //#define PIT_DEBUG
 
-static const double baseFrequency = 1193.1816666; // 1.193182 MHz
+static const double baseFrequency = 1193181.6666; // 1.193182 MHz
+static const double ticksPerNanosecond = baseFrequency / 1000000000;
 
 enum DecrementMode { DecrementBinary = 0, DecrementBCD = 1 };
 enum CounterAccessState { ReadLatchedLSB, ReadLatchedMSB, AccessMSBOnly, AccessLSBOnly, AccessLSBThenMSB, AccessMSBThenLSB };
 
 struct CounterInfo {
-    WORD startValue { 0xffff };
     WORD reload { 0xffff };
-    WORD value();
+    WORD value(QWORD now) const;
+    DWORD period() const { return reload ? reload : 0x10000; }
+    QWORD periodInNanoseconds() const { return period() / ticksPerNanosecond; }
     BYTE mode { 0 };
     DecrementMode decrementMode { DecrementBinary };
     WORD latchedValue { 0xffff };
     CounterAccessState accessState { ReadLatchedLSB };
     BYTE format { 0 };
-    QElapsedTimer qtimer;
-
-    void check(PIT&);
-    bool rolledOver { false };
+    // Machine clock time at which the counter was (re)loaded.
+    QWORD startTime { 0 };
 };
 
 struct PIT::Private
 {
     CounterInfo counter[3];
     int frequency { 0 };
-    OwnPtr<ThreadedTimer> threadedTimer;
+    EventScheduler::EventID irqEvent { 0 };
+    QWORD irqDeadline { 0 };
 };
 
 PIT::PIT(Machine& machine)
@@ -72,6 +75,7 @@ PIT::PIT(Machine& machine)
 
 PIT::~PIT()
 {
+    machine().scheduler().cancel(d->irqEvent);
 }
 
 void PIT::reset()
@@ -80,68 +84,84 @@ void PIT::reset()
     d->counter[0] = CounterInfo();
     d->counter[1] = CounterInfo();
     d->counter[2] = CounterInfo();
+
+    // FIXME: This should be done by the BIOS instead.
+    reconfigureTimer(0);
+    reconfigureTimer(1);
+    reconfigureTimer(2);
 }
 
-WORD CounterInfo::value()
+// Counter phases are saved relative to the machine clock, which starts over in a new process.
+void PIT::saveState(QDataStream& stream) const
 {
-    double nsec = qtimer.nsecsElapsed() / 1000;
-    int ticks = floor(nsec * baseFrequency);
-
-    int currentValue = startValue - ticks;
-    if (currentValue >= reload) {
-        vlog(LogTimer, "Current value{%d} >= reload{%d}", currentValue, reload);
-        if (reload == 0)
-            currentValue = 0;
-        else
-            currentValue %= reload;
-        rolledOver = true;
-    } else if (currentValue < 0) {
-        if (reload == 0)
-            currentValue = 0;
-        else
-            currentValue = currentValue % reload + reload;
-        rolledOver = true;
+    QWORD now = machine().scheduler().now();
+    for (auto& counter : d->counter) {
+        stream << counter.reload << counter.mode << (quint8)counter.decrementMode << counter.latchedValue;
+        stream << (quint8)counter.accessState << counter.format << (quint64)(now - counter.startTime);
     }
-
-#ifdef PIT_DEBUG
-    vlog(LogTimer, "nsec elapsed: %g, ticks: %g, value: %u", nsec, ticks, currentValue);
-#endif
-    return currentValue;
+    stream << (quint64)(d->irqDeadline > now ? d->irqDeadline - now : 0);
 }
 
-void CounterInfo::check(PIT& pit)
+void PIT::restoreState(QDataStream& stream)
 {
-    value();
-    if (rolledOver) {
-        if (mode == 0)
-            pit.raiseIRQ();
-        rolledOver = false;
+    QWORD now = machine().scheduler().now();
+    for (auto& counter : d->counter) {
+        quint8 decrementMode;
+        quint8 accessState;
+        quint64 elapsed;
+        stream >> counter.reload >> counter.mode >> decrementMode >> counter.latchedValue;
+        stream >> accessState >> counter.format >> elapsed;
+        counter.decrementMode = static_cast<DecrementMode>(decrementMode);
+        counter.accessState = static_cast<CounterAccessState>(accessState);
+        // This may wrap around, but value() only ever looks at the difference.
+        counter.startTime = now - elapsed;
     }
+    quint64 untilNextIRQ;
+    stream >> untilNextIRQ;
+    machine().scheduler().cancel(d->irqEvent);
+    scheduleIRQAt(now + untilNextIRQ);
+}
+
+WORD CounterInfo::value(QWORD now) const
+{
+    QWORD ticks = (now - startTime) * ticksPerNanosecond;
+    WORD currentValue = period() - (ticks % period());
+
+#ifdef PIT_DEBUG
+    vlog(LogTimer, "nsec elapsed: %llu, ticks: %llu, value: %u", now - startTime, ticks, currentValue);
+#endif
+    return currentValue;
 }
 
 void PIT::reconfigureTimer(BYTE index)
 {
     auto& counter = d->counter[index];
-    counter.qtimer.start();
+    counter.startTime = machine().scheduler().now();
+
+    // Only counter 0 is wired to an IRQ.
+    if (index == 0) {
+        machine().scheduler().cancel(d->irqEvent);
+        d->irqDeadline = counter.startTime;
+        scheduleIRQ();
+    }
 }
 
-void PIT::boot()
+void PIT::scheduleIRQ()
 {
-    d->threadedTimer = make<ThreadedTimer>(*this, 5);
-
-    // FIXME: This should be done by the BIOS instead.
-    reconfigureTimer(0);
-    reconfigureTimer(1);
-    reconfigureTimer(2);
+    // Ticks we were too late for are dropped rather than delivered back-to-back.
+    scheduleIRQAt(std::max(d->irqDeadline + d->counter[0].periodInNanoseconds(), machine().scheduler().now()));
 }
 
-void PIT::threadedTimerFired(Badge<ThreadedTimer>)
+void PIT::scheduleIRQAt(QWORD deadline)
 {
-#ifndef CT_DETERMINISTIC
-    d->counter[0].check(*this);
-    d->counter[1].check(*this);
-    d->counter[2].check(*this);
-#endif
+    d->irqDeadline = deadline;
+    d->irqEvent = machine().scheduler().scheduleAt(deadline, [this] {
+        // Mode 0 should only interrupt once, but the BIOS relies on it repeating.
+        BYTE mode = d->counter[0].mode;
+        if (mode == 0 || mode == 2 || mode == 3)
+            raiseIRQ();
+        scheduleIRQ();
+    });
 }
 
 BYTE PIT::readCounter(BYTE index)
@@ -164,11 +184,11 @@ BYTE PIT::readCounter(BYTE index)
         data = mostSignificant<BYTE>(counter.latchedValue);
         break;
     case AccessLSBThenMSB:
-        data = leastSignificant<BYTE>(counter.value());
+        data = leastSignificant<BYTE>(counter.value(machine().scheduler().now()));
         counter.accessState = AccessMSBThenLSB;
         break;
     case AccessMSBThenLSB:
-        data = mostSignificant<BYTE>(counter.value());
+        data = mostSignificant<BYTE>(counter.value(machine().scheduler().now()));
         counter.accessState = AccessLSBThenMSB;
         break;
     }
@@ -260,7 +280,7 @@ void PIT::modeControl(int timerIndex, BYTE data)
     switch (counter.format) {
     case 0:
         counter.accessState = ReadLatchedLSB;
-        counter.latchedValue = counter.value();
+        counter.latchedValue = counter.value(machine().scheduler().now());
         break;
     case 1:
         counter.accessState = AccessMSBOnly;
@@ -26,21 +26,18 @@
 
 #include "iodevice.h"
 #include "OwnPtr.h"
-#include "ThreadedTimer.h"
 
-class PIT final : public IODevice, public ThreadedTimer::Listener {
+class PIT final : public IODevice {
 public:
     explicit PIT(Machine&);
     virtual ~PIT();
 
     virtual void reset() override;
+    virtual void saveState(QDataStream&) const override;
+    virtual void restoreState(QDataStream&) override;
     virtual BYTE in8(WORD port) override;
     virtual void out8(WORD port, BYTE data) override;
 
-    void boot();
-
-    virtual void threadedTimerFired(Badge<ThreadedTimer>) override;
-
 private:
     friend class CPU;
 
@@ -49,6 +46,8 @@ private:
 
     void modeControl(int timerIndex, BYTE data);
     void reconfigureTimer(BYTE index);
+    void scheduleIRQ();
+    void scheduleIRQAt(QWORD deadline);
 
     struct Private;
     OwnPtr<Private> d;
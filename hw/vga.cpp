@@ -27,6 +27,7 @@
 #include "debug.h"
 #include "machine.h"
 #include "CPU.h"
+#include <QtCore/QDataStream>
 #include <QtGui/QColor>
 #include <QtGui/QBrush>
 
@@ -224,6 +225,69 @@ void VGA::reset()
     setPaletteDirty(true);
 }
 
+void VGA::saveState(QDataStream& stream) const
+{
+    stream.writeRawData(reinterpret_cast<const char*>(d->memory), 0x40000);
+    stream.writeRawData(reinterpret_cast<const char*>(d->latch), sizeof(d->latch));
+
+    stream << d->crtc.reg_index << d->crtc.vertical_display_end << d->crtc.maximum_scanline;
+    stream.writeRawData(reinterpret_cast<const char*>(d->crtc.reg), sizeof(d->crtc.reg));
+
+    stream << d->attr.next_3c0_is_index << d->attr.palette_address_source << d->attr.reg_index;
+    stream << d->attr.mode_control << d->attr.overscan_color << d->attr.color_plane_enable;
+    stream << d->attr.horizontal_pixel_panning << d->attr.color_select;
+    stream.writeRawData(reinterpret_cast<const char*>(d->attr.palette_reg), sizeof(d->attr.palette_reg));
+
+    stream << d->sequencer.reg_index;
+    stream.writeRawData(reinterpret_cast<const char*>(d->sequencer.reg), sizeof(d->sequencer.reg));
+
+    stream << d->graphics_ctrl.reg_index << d->graphics_ctrl.memory_map_select << d->graphics_ctrl.alphanumeric_mode_disable;
+    stream.writeRawData(reinterpret_cast<const char*>(d->graphics_ctrl.reg), sizeof(d->graphics_ctrl.reg));
+
+    stream << d->misc_output.vertical_sync_polarity << d->misc_output.horizontal_sync_polarity;
+    stream << d->misc_output.odd_even_page_select << d->misc_output.clock_select;
+    stream << d->misc_output.ram_enable << d->misc_output.input_output_address_select;
+
+    stream << d->dac.data_read_index << d->dac.data_read_subindex << d->dac.data_write_index << d->dac.data_write_subindex << d->dac.mask;
+    stream.writeRawData(reinterpret_cast<const char*>(d->dac.color), sizeof(d->dac.color));
+
+    stream << d->columns << d->rows << d->vga_enabled << d->write_protect << d->statusRegister;
+}
+
+void VGA::restoreState(QDataStream& stream)
+{
+    stream.readRawData(reinterpret_cast<char*>(d->memory), 0x40000);
+    stream.readRawData(reinterpret_cast<char*>(d->latch), sizeof(d->latch));
+
+    stream >> d->crtc.reg_index >> d->crtc.vertical_display_end >> d->crtc.maximum_scanline;
+    stream.readRawData(reinterpret_cast<char*>(d->crtc.reg), sizeof(d->crtc.reg));
+
+    stream >> d->attr.next_3c0_is_index >> d->attr.palette_address_source >> d->attr.reg_index;
+    stream >> d->attr.mode_control >> d->attr.overscan_color >> d->attr.color_plane_enable;
+    stream >> d->attr.horizontal_pixel_panning >> d->attr.color_select;
+    stream.readRawData(reinterpret_cast<char*>(d->attr.palette_reg), sizeof(d->attr.palette_reg));
+
+    stream >> d->sequencer.reg_index;
+    stream.readRawData(reinterpret_cast<char*>(d->sequencer.reg), sizeof(d->sequencer.reg));
+
+    stream >> d->graphics_ctrl.reg_index >> d->graphics_ctrl.memory_map_select >> d->graphics_ctrl.alphanumeric_mode_disable;
+    stream.readRawData(reinterpret_cast<char*>(d->graphics_ctrl.reg), sizeof(d->graphics_ctrl.reg));
+
+    stream >> d->misc_output.vertical_sync_polarity >> d->misc_output.horizontal_sync_polarity;
+    stream >> d->misc_output.odd_even_page_select >> d->misc_output.clock_select;
+    stream >> d->misc_output.ram_enable >> d->misc_output.input_output_address_select;
+
+    stream >> d->dac.data_read_index >> d->dac.data_read_subindex >> d->dac.data_write_index >> d->dac.data_write_subindex >> d->dac.mask;
+    stream.readRawData(reinterpret_cast<char*>(d->dac.color), sizeof(d->dac.color));
+
+    stream >> d->columns >> d->rows >> d->vga_enabled >> d->write_protect >> d->statusRegister;
+
+    synchronizeColors();
+    d->paletteDirty = false;
+    setPaletteDirty(true);
+    machine().notifyScreen();
+}
+
 void VGA::out8(WORD port, BYTE data)
 {
     machine().notifyScreen();
@@ -885,6 +949,29 @@ void VGA::writeMemory8(DWORD address, BYTE value)
         d->plane[3][offset] = new_val[3];
 }
 
+// Wide accesses go through the planes a byte at a time, but without dispatching on every byte.
+void VGA::writeMemory16(DWORD address, WORD value)
+{
+    VGA::writeMemory8(address, leastSignificant<BYTE>(value));
+    VGA::writeMemory8(address + 1, mostSignificant<BYTE>(value));
+}
+
+void VGA::writeMemory32(DWORD address, DWORD value)
+{
+    VGA::writeMemory16(address, leastSignificant<WORD>(value));
+    VGA::writeMemory16(address + 2, mostSignificant<WORD>(value));
+}
+
+WORD VGA::readMemory16(DWORD address)
+{
+    return weld<WORD>(VGA::readMemory8(address + 1), VGA::readMemory8(address));
+}
+
+DWORD VGA::readMemory32(DWORD address)
+{
+    return weld<DWORD>(VGA::readMemory16(address + 2), VGA::readMemory16(address));
+}
+
 BYTE VGA::readMemory8(DWORD address)
 {
     DWORD offset;
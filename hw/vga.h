@@ -38,12 +38,18 @@ public:
 
     // IODevice
     virtual void reset() override;
+    virtual void saveState(QDataStream&) const override;
+    virtual void restoreState(QDataStream&) override;
     virtual BYTE in8(WORD port) override;
     virtual void out8(WORD port, BYTE data) override;
 
     // MemoryProvider
     virtual void writeMemory8(DWORD address, BYTE value) override;
+    virtual void writeMemory16(DWORD address, WORD value) override;
+    virtual void writeMemory32(DWORD address, DWORD value) override;
     virtual BYTE readMemory8(DWORD address) override;
+    virtual WORD readMemory16(DWORD address) override;
+    virtual DWORD readMemory32(DWORD address) override;
 
     const BYTE* plane(int index) const;
     const BYTE* text_memory() const;
@@ -27,6 +27,7 @@
 #include "Common.h"
 #include "debug.h"
 #include "machine.h"
+#include <QtCore/QDataStream>
 #include <stdio.h>
 
 struct VomCtl::Private
@@ -66,6 +67,16 @@ void VomCtl::reset()
     d->consoleWriteBuffer = QString();
 }
 
+void VomCtl::saveState(QDataStream& stream) const
+{
+    stream << m_registerIndex << d->consoleWriteBuffer;
+}
+
+void VomCtl::restoreState(QDataStream& stream)
+{
+    stream >> m_registerIndex >> d->consoleWriteBuffer;
+}
+
 BYTE VomCtl::in8(WORD port)
 {
     switch (port) {
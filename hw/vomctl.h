@@ -33,6 +33,8 @@ public:
     virtual ~VomCtl();
 
     virtual void reset() override;
+    virtual void saveState(QDataStream&) const override;
+    virtual void restoreState(QDataStream&) override;
     virtual void out8(WORD port, BYTE data) override;
     virtual BYTE in8(WORD port) override;
 
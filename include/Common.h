@@ -42,6 +42,7 @@
 #define PURE __attribute__ ((pure))
 #define LIKELY(x) __builtin_expect(!!(x), 1)
 #define UNLIKELY(x) __builtin_expect(!!(x), 0)
+#define PRINTF_FORMAT(formatIndex, firstArgumentIndex) __attribute__((format(printf, formatIndex, firstArgumentIndex)))
 #define UNUSED_PARAM(x) (void)(x)
 
 #define MAX_FN_LENGTH	128
@@ -63,8 +64,12 @@ struct RuntimeOptions {
     bool crashOnGPF { false };
     bool crashOnException { false };
     bool stacklog { false };
+    bool benchmark { false };
+    // Nominal MHz of the deterministic virtual clock, or 0 to follow the host clock.
+    unsigned virtualClockMHz { 0 };
     QString autotestPath;
     QString configPath;
+    QString restoreStatePath;
 #ifdef DISASSEMBLE_EVERYTHING
     bool disassembleEverything { false };
 #endif
@@ -63,4 +63,6 @@ private:
     void handleDumpUnassembled(const QStringList&);
     void handleSelector(const QStringList&);
     void handleStack(const QStringList&);
+    void handleSaveState(const QStringList&);
+    void handleRestoreState(const QStringList&);
 };
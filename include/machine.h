@@ -39,6 +39,7 @@ class IODevice;
 class BusMouse;
 class CMOS;
 class DiskDrive;
+class EventScheduler;
 class FDC;
 class IDE;
 class Keyboard;
@@ -63,6 +64,7 @@ public:
     virtual ~Machine();
 
     CPU& cpu() { return *m_cpu; }
+    EventScheduler& scheduler() { return *m_scheduler; }
     VGA& vga() { return *m_vga; }
     PIT& pit() { return *m_pit; }
     BusMouse& busMouse() { return *m_busMouse; }
@@ -88,6 +90,9 @@ public:
 
     void forEachIODevice(std::function<void(IODevice&)>);
 
+    bool saveState(const QString& fileName);
+    bool restoreState(const QString& fileName);
+
     IODevice* inputDeviceForPort(WORD port);
     IODevice* outputDeviceForPort(WORD port);
 
@@ -113,6 +118,8 @@ private:
     bool loadFile(DWORD address, const QString& fileName);
     bool loadROMImage(DWORD address, const QString& fileName);
 
+    QVector<IODevice*> devicesInStateOrder();
+
     void applySettings();
 
     Worker& worker() { return *m_worker; }
@@ -121,6 +128,7 @@ private:
     IODevice* outputDeviceForPortSlowCase(WORD port);
 
     OwnPtr<Settings> m_settings;
+    OwnPtr<EventScheduler> m_scheduler;
     OwnPtr<CPU> m_cpu;
 
     OwnPtr<Worker> m_worker;
@@ -26,6 +26,7 @@
 #include "settings.h"
 #include "CPU.h"
 #include "DiskDrive.h"
+#include "EventScheduler.h"
 #include "iodevice.h"
 #include "fdc.h"
 #include "ide.h"
@@ -40,7 +41,9 @@
 #include "worker.h"
 #include "screen.h"
 #include "machinewidget.h"
+#include <QtCore/QDataStream>
 #include <QtCore/QFile>
+#include <QtCore/QSaveFile>
 
 OwnPtr<Machine> Machine::createFromFile(const QString& fileName)
 {
@@ -123,6 +126,7 @@ void Machine::didInitializeWorker(Badge<Worker>)
 void Machine::makeCPU(Badge<Worker>)
 {
     RELEASE_ASSERT(QThread::currentThread() == m_worker.ptr());
+    m_scheduler = make<EventScheduler>();
     m_cpu = make<CPU>(*this);
 }
 
@@ -153,7 +157,10 @@ void Machine::makeDevices(Badge<Worker>)
     m_pit = make<PIT>(*this);
     m_vga = make<VGA>(*this);
 
-    pit().boot();
+    if (!options.restoreStatePath.isEmpty() && !restoreState(options.restoreStatePath)) {
+        vlog(LogExit, "Failed to restore machine state from %s", qPrintable(options.restoreStatePath));
+        hard_exit(1);
+    }
 }
 
 void Machine::applySettings()
@@ -269,6 +276,158 @@ void Machine::resetAllIODevices()
     });
 }
 
+static const quint32 stateFileMagic = 0x43545353; // "CTSS"
+static const quint32 stateFileVersion = 2;
+
+// Devices are stored in a fixed order (m_allDevices is unordered), each as its
+// name followed by a length-prefixed blob so a mismatch is caught at the right device.
+QVector<IODevice*> Machine::devicesInStateOrder()
+{
+    return {
+        m_masterPIC.ptr(),
+        m_slavePIC.ptr(),
+        m_pit.ptr(),
+        m_cmos.ptr(),
+        m_keyboard.ptr(),
+        m_ps2.ptr(),
+        m_busMouse.ptr(),
+        m_fdc.ptr(),
+        m_ide.ptr(),
+        m_vga.ptr(),
+        m_vomCtl.ptr(),
+    };
+}
+
+template<typename T>
+static QByteArray stateBlob(const T& object)
+{
+    QByteArray blob;
+    QDataStream stream(&blob, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_0);
+    object.saveState(stream);
+    return blob;
+}
+
+template<typename T>
+static bool restoreFromStateBlob(T& object, const QByteArray& blob)
+{
+    QDataStream stream(blob);
+    stream.setVersion(QDataStream::Qt_5_0);
+    object.restoreState(stream);
+    return stream.status() == QDataStream::Ok && stream.atEnd();
+}
+
+bool Machine::saveState(const QString& fileName)
+{
+    RELEASE_ASSERT(QThread::currentThread() == m_worker.ptr());
+
+    // Written to a temporary file that replaces the old one on commit(). Guest RAM may be
+    // a private mapping of the old file (after a restore), which must not be truncated under it.
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        vlog(LogConfig, "Failed to open %s for writing", qPrintable(fileName));
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << stateFileMagic << stateFileVersion << (quint32)cpu().memorySize();
+    stream << stateBlob(cpu());
+
+    for (IODevice* device : devicesInStateOrder())
+        stream << QByteArray(device->name()) << stateBlob(*device);
+
+    // Guest RAM goes last, page aligned, so restoreState() can map it straight from the file.
+    QByteArray padding(((file.pos() + 4095) & ~(qint64)4095) - file.pos(), 0);
+    if (stream.status() != QDataStream::Ok || file.write(padding) != padding.size() || !cpu().saveMemory(file) || !file.commit()) {
+        vlog(LogConfig, "Failed to write machine state to %s", qPrintable(fileName));
+        return false;
+    }
+
+    vlog(LogConfig, "Saved machine state to %s", qPrintable(fileName));
+    return true;
+}
+
+// The whole file is read and checked before anything is applied, so a bad file leaves the machine as it was.
+bool Machine::restoreState(const QString& fileName)
+{
+    RELEASE_ASSERT(QThread::currentThread() == m_worker.ptr());
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        vlog(LogConfig, "Failed to open %s", qPrintable(fileName));
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic;
+    quint32 version;
+    stream >> magic >> version;
+    if (stream.status() != QDataStream::Ok || magic != stateFileMagic || version != stateFileVersion) {
+        vlog(LogConfig, "%s is not a version %u machine state file", qPrintable(fileName), stateFileVersion);
+        return false;
+    }
+
+    quint32 memorySize;
+    QByteArray cpuBlob;
+    stream >> memorySize >> cpuBlob;
+    if (stream.status() != QDataStream::Ok || !memorySize || (memorySize & 4095)) {
+        vlog(LogConfig, "Bad CPU state in %s", qPrintable(fileName));
+        return false;
+    }
+
+    auto devices = devicesInStateOrder();
+    QVector<QByteArray> deviceBlobs;
+    for (IODevice* device : devices) {
+        QByteArray name;
+        QByteArray blob;
+        stream >> name >> blob;
+        if (stream.status() != QDataStream::Ok || name != device->name()) {
+            vlog(LogConfig, "Expected state for %s in %s", device->name(), qPrintable(fileName));
+            return false;
+        }
+        deviceBlobs.append(blob);
+    }
+
+    qint64 memoryOffset = (file.pos() + 4095) & ~(qint64)4095;
+    BYTE* memory = file.seek(memoryOffset) ? CPU::loadMemoryImage(file, memorySize) : nullptr;
+    if (!memory) {
+        vlog(LogConfig, "Failed to read guest memory from %s", qPrintable(fileName));
+        return false;
+    }
+
+    // A blob can still turn out to be truncated or malformed as it's applied.
+    // Keep the current state around so we can go back to it if that happens.
+    QByteArray undoCPUBlob = stateBlob(cpu());
+    QVector<QByteArray> undoDeviceBlobs;
+    for (IODevice* device : devices)
+        undoDeviceBlobs.append(stateBlob(*device));
+
+    const char* badState = nullptr;
+    if (!restoreFromStateBlob(cpu(), cpuBlob))
+        badState = "CPU";
+    for (int i = 0; !badState && i < devices.size(); ++i) {
+        if (!restoreFromStateBlob(*devices[i], deviceBlobs[i]))
+            badState = devices[i]->name();
+    }
+
+    if (badState) {
+        vlog(LogConfig, "Bad state for %s in %s", badState, qPrintable(fileName));
+        restoreFromStateBlob(cpu(), undoCPUBlob);
+        for (int i = 0; i < devices.size(); ++i)
+            restoreFromStateBlob(*devices[i], undoDeviceBlobs[i]);
+        CPU::discardMemoryImage(memory, memorySize);
+        return false;
+    }
+
+    cpu().adoptMemoryImage(memory, memorySize);
+
+    vlog(LogConfig, "Restored machine state from %s", qPrintable(fileName));
+    return true;
+}
+
 IODevice* Machine::inputDeviceForPortSlowCase(WORD port)
 {
     return m_allInputDevices.value(port, nullptr);
@@ -0,0 +1,42 @@
+[bits 16]
+
+; Reboot through the fast reset bit in port 0x92, then make sure the
+; PIT still gets IRQ0 through after the cycle counter has started over.
+
+cli
+cmp byte [cs:rebooted], 0
+jne after_reboot
+mov byte [cs:rebooted], 1
+mov al, 0x01
+out 0x92, al
+jmp $
+
+after_reboot:
+xor ax, ax
+mov ds, ax
+mov ss, ax
+mov sp, 0x7c00
+mov word [0x20], irq0
+mov word [0x22], cs
+mov al, 0x36
+out 0x43, al
+xor al, al
+out 0x40, al
+out 0x40, al
+mov al, 0xfe
+out 0x21, al
+sti
+hlt
+cli
+
+db 0xf1
+
+irq0:
+mov al, 0xff
+out 0x21, al
+mov al, 0x20
+out 0x20, al
+iret
+
+rebooted:
+db 0
@@ -0,0 +1,17 @@
+[bits 16]
+
+; Execute an instruction once so it's cached, then patch its immediate
+; and make sure the second pass sees the new value.
+
+xor cx, cx
+again:
+patch:
+mov al, 0x11
+inc cx
+cmp cx, 2
+je done
+mov byte [cs:patch + 1], 0x22
+jmp again
+done:
+
+db 0xf1
@@ -0,0 +1,34 @@
+[bits 16]
+
+; A tight mix of common register, memory and branch instructions,
+; so that the run time is dominated by instruction dispatch.
+
+    cli
+    mov ax, 0x2000
+    mov ds, ax
+    xor si, si
+    mov di, 7
+    mov dx, 100
+
+outer:
+    mov cx, 0xffff
+
+inner:
+    mov ax, [0]
+    add ax, cx
+    mov [0], ax
+    xor bx, ax
+    shl bx, 1
+    inc si
+    and si, 15
+    cmp si, di
+    jne skip
+    mov [2], bx
+skip:
+    dec cx
+    jnz inner
+
+    dec dx
+    jnz outer
+
+    db 0xf1
@@ -0,0 +1,25 @@
+#!/bin/bash
+
+# Runs a benchmark program and prints how fast the emulator got through it.
+# To compare dispatch strategies, build once as usual and once with
+# CT_MEMBER_FUNCTION_DISPATCH defined, and run the same benchmark on both.
+
+if [ "$1" = "" ] ; then
+	echo "usage: bash $0 <benchmark.asm> [extra computron arguments]"
+	exit 1
+fi
+
+PROGRAM="../../computron --no-gui --no-vlog --benchmark --run"
+BENCHMARK=$1
+shift
+COMPILED=`mktemp /tmp/tmp.XXXXXX || exit 1`
+
+nasm -f bin -o $COMPILED $BENCHMARK || \
+	{ rm -f $COMPILED
+	  exit 1
+	}
+
+echo -n "$BENCHMARK: "
+$PROGRAM $COMPILED "$@" | tail -n 1
+
+rm -f $COMPILED
@@ -27,9 +27,8 @@
 #include "debug.h"
 #include "machine.h"
 #include "DiskDrive.h"
+#include "EventScheduler.h"
 #include <stdio.h>
-#include <time.h>
-#include <sys/time.h>
 
 #define FD_NO_ERROR             0x00
 #define FD_BAD_COMMAND          0x01
@@ -91,9 +90,6 @@ void vm_handleE6(CPU& cpu)
     extern WORD kbd_hit();
     extern WORD kbd_getc();
 
-    struct    tm *t;
-    time_t    curtime;
-    struct    timeval timv;
     DWORD tick_count;
     DiskDrive* drive;
 
@@ -105,19 +101,15 @@ void vm_handleE6(CPU& cpu)
         } else {
             cpu.setAX(0);
             cpu.setZF(1);
+            // The INT 16h frame and the BIOS stub's own pushes are written each time around.
+            cpu.noteIdlePoll(16);
         }
         break;
     case 0x1A00:
         // Interrupt 1A, 00: Get RTC tick count
         cpu.setAL(0); // Midnight flag.
-        curtime = time(nullptr);
-        t = localtime(&curtime);
-        tick_count = ((t->tm_hour*3600) + (t->tm_min*60) + (t->tm_sec)) * 18.206; // yuck..
-        gettimeofday(&timv, NULL);
-        tick_count += timv.tv_usec / 54926.9471602768;
-#ifdef CT_DETERMINISTIC
-        tick_count = 0x12345678;
-#endif
+        // 18.2 ticks per second since midnight, on the same clock as the PIT and CMOS.
+        tick_count = cpu.machine().scheduler().currentDateTime().time().msecsSinceStartOfDay() / 54.9254935;
         cpu.setCX(mostSignificant<WORD>(tick_count));
         cpu.setDX(leastSignificant<WORD>(tick_count));
         cpu.writePhysicalMemory<DWORD>(PhysicalAddress(0x046c), tick_count);
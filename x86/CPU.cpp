@@ -30,10 +30,14 @@
 #include "pic.h"
 #include "settings.h"
 #include <unistd.h>
+#include <sys/mman.h>
 #include "pit.h"
 #include "Tasking.h"
+#include "EventScheduler.h"
 
 //#define DEBUG_PAGING
+//#define DEBUG_BASIC_BLOCKS
+//#define DEBUG_IDLE_POLLING
 #define CRASH_ON_OPCODE_00_00
 //#define CRASH_ON_EXECUTE_00000000
 #define CRASH_ON_PE_JMP_00000000
@@ -140,9 +144,29 @@ FLATTEN void CPU::decodeNext()
         ASSERT_NOT_REACHED();
 #endif
 
+    PhysicalAddress physicalAddress;
+    if (auto* cachedInsn = cachedInstructionAtCurrentInstructionPointer(physicalAddress)) {
+        // Execute a copy, since the instruction may invalidate its own code page.
+        Instruction insn = *cachedInsn;
+        adjustInstructionPointer(insn.length());
+        execute(insn);
+        return;
+    }
+
+    DWORD startOffset = currentInstructionPointer();
+    m_fetchWindow = FetchWindow();
     auto insn = Instruction::fromStream(*this, m_operandSize32, m_addressSize32);
     if (!insn.isValid())
         throw InvalidOpcode();
+
+    // Don't cache instructions that wrapped around the end of the code segment,
+    // or that came from a memory provider that may not read back what was written.
+    if (((QWORD)startOffset + insn.length()) <= (x32() ? 0x100000000 : 0x10000)) {
+        auto* provider = memoryProviderForAddress(physicalAddress);
+        if (!provider || provider->pointerForDirectReadAccess())
+            m_instructionCache.add(physicalAddress, insn, m_operandSize32, m_addressSize32);
+    }
+
     execute(insn);
 }
 
@@ -169,6 +193,7 @@ void CPU::_RDTSC(Instruction&)
     if (getPE() && getCPL() != 0) {
         throw GeneralProtectionFault(0, "RDTSC with CPL != 0");
     }
+    // Under a virtual clock, this is exactly what machine time is derived from.
     setEDX(m_cycle >> 32);
     setEAX(m_cycle);
 }
@@ -180,11 +205,16 @@ void CPU::_WBINVD(Instruction&)
     }
 }
 
-void CPU::_INVLPG(Instruction&)
+void CPU::_INVLPG(Instruction& insn)
 {
     if (getPE() && getCPL() != 0) {
         throw GeneralProtectionFault(0, "INVLPG");
     }
+    auto& modrm = insn.modrm();
+    if (modrm.isRegister())
+        throw InvalidOpcode("INVLPG with register operand");
+    m_tlb.flushPage(cachedDescriptor(modrm.segment()).linearAddress(modrm.offset()));
+    m_instructionCache.invalidateLinks();
 }
 
 void CPU::_VKILL(Instruction&)
@@ -195,21 +225,69 @@ void CPU::_VKILL(Instruction&)
     }
     vlog(LogCPU, "0xF1: Secret shutdown command received!");
     //dumpAll();
+    if (options.benchmark) {
+        qint64 elapsed = std::max<qint64>(m_benchmarkTimer.elapsed(), 1);
+        printf("%llu instructions in %lld ms (%.2f MIPS)\n", (unsigned long long)m_cycle, (long long)elapsed, m_cycle / (elapsed * 1000.0));
+    }
     hard_exit(0);
 }
 
+// Guest RAM is anonymous memory: the kernel hands out zeroed pages as the guest first touches them,
+// so memory the guest never uses costs nothing, and allocating it takes no time at all.
+static BYTE* allocateGuestMemory(DWORD size)
+{
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_NORESERVE
+    flags |= MAP_NORESERVE;
+#endif
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (memory == MAP_FAILED) {
+        vlog(LogInit, "Insufficient memory available.");
+        hard_exit(1);
+    }
+#ifdef MADV_HUGEPAGE
+    madvise(memory, size, MADV_HUGEPAGE);
+#endif
+    return static_cast<BYTE*>(memory);
+}
+
+static void freeGuestMemory(BYTE* memory, DWORD size)
+{
+    if (memory)
+        munmap(memory, size);
+}
+
 void CPU::setMemorySizeAndReallocateIfNeeded(DWORD size)
 {
     if (m_memorySize == size)
         return;
-    delete [] m_memory;
+    freeGuestMemory(m_memory, m_memorySize);
     m_memorySize = size;
-    m_memory = new BYTE[m_memorySize];
-    if (!m_memory) {
-        vlog(LogInit, "Insufficient memory available.");
-        hard_exit(1);
-    }
-    memset(m_memory, 0x0, m_memorySize);
+    m_memory = allocateGuestMemory(m_memorySize);
+    m_instructionCache.setPhysicalMemorySize(m_memorySize);
+    m_descriptorCache.setPhysicalMemorySize(m_memorySize);
+    m_dirtyPages.setPhysicalMemorySize(m_memorySize);
+    flushTLB();
+}
+
+void CPU::discardMemoryImage(BYTE* memory, DWORD size)
+{
+    freeGuestMemory(memory, size);
+}
+
+void CPU::adoptMemoryImage(BYTE* memory, DWORD size)
+{
+    freeGuestMemory(m_memory, m_memorySize);
+    m_memory = memory;
+    m_memorySize = size;
+
+    // Nothing may keep pointing into the old RAM. We may be called from inside an instruction
+    // (e.g the debugger under HLT), so the instruction cache retires its pages rather than deleting them.
+    m_instructionCache.setPhysicalMemorySize(m_memorySize);
+    m_descriptorCache.setPhysicalMemorySize(m_memorySize);
+    m_dirtyPages.setPhysicalMemorySize(m_memorySize);
+    m_fetchWindow = FetchWindow();
+    flushTLB();
 }
 
 CPU::CPU(Machine& m)
@@ -236,17 +314,19 @@ CPU::CPU(Machine& m)
         m_vmm_names.append(line.trimmed());
     }
 #endif
-    m_isForAutotest = machine().isForAutotest();
+    // Benchmark runs are autotests without the per-instruction trace.
+    m_isForAutotest = machine().isForAutotest() && !options.benchmark;
 
     buildOpcodeTablesIfNeeded();
 
+    if (options.virtualClockMHz)
+        machine().scheduler().setVirtualClock(&m_cycle, options.virtualClockMHz);
+
     ASSERT(!g_cpu);
     g_cpu = this;
 
     setMemorySizeAndReallocateIfNeeded(8192 * 1024);
 
-    memset(m_memoryProviders, 0, sizeof(m_memoryProviders));
-
     m_debugger = make<Debugger>(*this);
 
     m_controlRegisterMap[0] = &m_CR0;
@@ -291,13 +371,14 @@ CPU::CPU(Machine& m)
 void CPU::reset()
 {
     m_a20Enabled = false;
-    m_nextInstructionIsUninterruptible = false;
+    setPendingEvent(PendingUninterruptible, false);
 
     memset(&m_generalPurposeRegister, 0, sizeof(m_generalPurposeRegister));
     m_CR0 = 0;
     m_CR2 = 0;
     m_CR3 = 0;
     m_CR4 = 0;
+    flushTLB();
     m_DR0 = 0;
     m_DR1 = 0;
     m_DR2 = 0;
@@ -336,7 +417,7 @@ void CPU::reset()
     setFS(0);
     setGS(0);
 
-    if (m_isForAutotest)
+    if (machine().isForAutotest())
         farJump(LogicalAddress(machine().settings().entryCS(), machine().settings().entryIP()), JumpType::Internal);
     else
         farJump(LogicalAddress(0xf000, 0x0000), JumpType::Internal);
@@ -355,8 +436,15 @@ void CPU::reset()
     m_dirtyFlags = 0;
     m_lastResult = 0;
     m_lastOpSize = ByteSize;
+    m_lastArithmeticResult = 0;
+    m_lastArithmeticDest = 0;
+    m_lastArithmeticSrc = 0;
+    m_lastArithmeticOpSize = ByteSize;
+    m_lastArithmeticOperation = LazyOperation::Add;
 
+    machine().scheduler().rebaseVirtualClock(0);
     m_cycle = 0;
+    m_nextSchedulerCheckCycle = 0;
 
     initWatches();
 
@@ -365,7 +453,7 @@ void CPU::reset()
 
 CPU::~CPU()
 {
-    delete [] m_memory;
+    freeGuestMemory(m_memory, m_memorySize);
     m_memory = nullptr;
 }
 
@@ -397,25 +485,331 @@ FLATTEN void CPU::executeOneInstruction()
     }
 }
 
+// Whether we can go straight into the next block without a trip through the main loop.
+ALWAYS_INLINE bool CPU::canChainBasicBlocks() const
+{
+    if (UNLIKELY(m_cycle >= m_nextSchedulerCheckCycle))
+        return false;
+    DWORD pendingEvents = m_pendingEvents;
+    if (LIKELY(!pendingEvents))
+        return true;
+    // A pending IRQ is no reason to stop while interrupts are disabled.
+    return pendingEvents == PendingIRQ && !getIF();
+}
+
+// Instantiated once per execution mode, so that lookups of the next block don't have to
+// re-check which mode the CPU is in. Returns to the main loop as soon as the mode changes.
+template<CPU::ExecutionMode mode>
+FLATTEN void CPU::executeBasicBlocks()
+{
+    BasicBlock* block = nullptr;
+    try {
+        InstructionExecutionContext context(*this);
+        block = basicBlockAtCurrentInstructionPointer<mode>();
+    } catch(Exception e) {
+        if (options.log_exceptions)
+            dumpDisassembled(cachedDescriptor(SegmentRegisterIndex::CS), m_baseEIP, 3);
+        raiseException(e);
+        return;
+    }
+
+    if (!block || block->instructions.empty()) {
+        executeOneInstruction();
+        return;
+    }
+
+    forever {
+        if (!executeBasicBlock(*block) || !canChainBasicBlocks())
+            return;
+        if (executionMode() != mode)
+            return;
+
+        auto* nextBlock = block->linkedBlock(getEIP(), m_instructionCache.generation());
+        if (!nextBlock) {
+            try {
+                InstructionExecutionContext context(*this);
+                nextBlock = basicBlockAtCurrentInstructionPointer<mode>();
+            } catch(Exception e) {
+                if (options.log_exceptions)
+                    dumpDisassembled(cachedDescriptor(SegmentRegisterIndex::CS), m_baseEIP, 3);
+                raiseException(e);
+                return;
+            }
+            if (!nextBlock || nextBlock->instructions.empty())
+                return;
+            block->link(getEIP(), nextBlock, m_instructionCache.generation());
+        }
+        block = nextBlock;
+    }
+}
+
+FLATTEN bool CPU::executeBasicBlock(BasicBlock& block)
+{
+    QWORD generation = m_instructionCache.generation();
+    size_t count = block.instructions.size();
+    if (block.fusion != Instruction::Fusion::None)
+        count -= 2;
+    for (size_t i = 0; i < count; ++i) {
+        if (!executeInstructionInBlock(block.instructions[i], generation))
+            return false;
+    }
+    if (block.fusion != Instruction::Fusion::None)
+        executeFusedPair(block.instructions[count], block.instructions[count + 1], block.fusion);
+    return true;
+}
+
+// Returns false if the rest of the block must not be executed.
+FLATTEN bool CPU::executeInstructionInBlock(Instruction& insn, QWORD generation)
+{
+    try {
+        InstructionExecutionContext context(*this);
+#ifdef CT_TRACE
+        if (UNLIKELY(m_isForAutotest))
+            dumpTrace();
+#endif
+        adjustInstructionPointer(insn.length());
+        execute(insn);
+    } catch(Exception e) {
+        if (options.log_exceptions)
+            dumpDisassembled(cachedDescriptor(SegmentRegisterIndex::CS), m_baseEIP, 3);
+        raiseException(e);
+        return false;
+    } catch(HardwareInterruptDuringREP) {
+        setEIP(currentBaseInstructionPointer());
+        return false;
+    }
+
+    // The rest of the block may be stale if its code was written to, or if address translation changed.
+    return m_instructionCache.generation() == generation;
+}
+
+// Runs a CMP, TEST or DEC together with the conditional branch after it.
+// The first instruction only has register and immediate operands, so neither half can fault.
+// Flags are recorded just like the separate instructions would, but the common conditions
+// are decided straight from the operands.
+FLATTEN void CPU::executeFusedPair(Instruction& insn, Instruction& branch, Instruction::Fusion fusion)
+{
+    saveBaseAddress();
+    adjustInstructionPointer(insn.length());
+
+    bool byteSized = !(insn.op() & 1) && (insn.op() < 0x48 || insn.op() > 0x4F);
+    bool taken;
+    if (byteSized)
+        taken = executeFusedHead<BYTE>(insn, fusion, branch.cc());
+    else if (insn.o32())
+        taken = executeFusedHead<DWORD>(insn, fusion, branch.cc());
+    else
+        taken = executeFusedHead<WORD>(insn, fusion, branch.cc());
+    ++m_cycle;
+
+    saveBaseAddress();
+    adjustInstructionPointer(branch.length());
+    if (taken) {
+        if (branch.op() == 0x0F)
+            jumpRelative32(branch.immAddress());
+        else
+            jumpRelative8(branch.imm8());
+    }
+    ++m_cycle;
+}
+
+template<typename T>
+ALWAYS_INLINE bool CPU::executeFusedHead(Instruction& insn, Instruction::Fusion fusion, BYTE conditionCode)
+{
+    typedef typename std::make_signed<T>::type ST;
+
+    if (fusion == Instruction::Fusion::Decrement) {
+        int index = insn.hasRM() ? insn.rm() & 7 : insn.registerIndex();
+        if constexpr (sizeof(T) == 1)
+            doDEC<T>(RegisterAccessor<T>(*m_byteRegisters[index]));
+        else if constexpr (sizeof(T) == 2)
+            doDEC<T>(RegisterAccessor<T>(m_generalPurposeRegister[index].lowWORD));
+        else
+            doDEC<T>(RegisterAccessor<T>(m_generalPurposeRegister[index].fullDWORD));
+        switch (conditionCode) {
+        case 4: return readRegister<T>(index) == 0;
+        case 5: return readRegister<T>(index) != 0;
+        default: return evaluate(conditionCode);
+        }
+    }
+
+    T dest;
+    T src;
+    switch (insn.op()) {
+    case 0x38: case 0x39: case 0x84: case 0x85:
+        dest = readRegister<T>(insn.rm() & 7);
+        src = readRegister<T>(insn.registerIndex());
+        break;
+    case 0x3A: case 0x3B:
+        dest = readRegister<T>(insn.registerIndex());
+        src = readRegister<T>(insn.rm() & 7);
+        break;
+    case 0x3C: case 0x3D: case 0xA8: case 0xA9:
+        dest = readRegister<T>(RegisterAL);
+        src = sizeof(T) == 1 ? insn.imm8() : sizeof(T) == 2 ? insn.imm16() : insn.imm32();
+        break;
+    case 0x83:
+        dest = readRegister<T>(insn.rm() & 7);
+        src = signExtendedTo<T>(insn.imm8());
+        break;
+    default: // 0x80, 0x81, 0xF6, 0xF7
+        dest = readRegister<T>(insn.rm() & 7);
+        src = sizeof(T) == 1 ? insn.imm8() : sizeof(T) == 2 ? insn.imm16() : insn.imm32();
+        break;
+    }
+
+    if (fusion == Instruction::Fusion::Test) {
+        T result = dest & src;
+        updateFlags<T>(result);
+        setOF(0);
+        setCF(0);
+        bool sign = static_cast<ST>(result) < 0;
+        switch (conditionCode) {
+        case 2: return false;
+        case 3: return true;
+        case 4: case 6: return result == 0;
+        case 5: case 7: return result != 0;
+        case 8: case 12: return sign;
+        case 9: case 13: return !sign;
+        case 14: return sign || result == 0;
+        case 15: return !sign && result != 0;
+        default: return evaluate(conditionCode);
+        }
+    }
+
+    cmpFlags<T>((typename TypeDoubler<T>::type)dest - src, dest, src);
+    switch (conditionCode) {
+    case 2: return dest < src;
+    case 3: return dest >= src;
+    case 4: return dest == src;
+    case 5: return dest != src;
+    case 6: return dest <= src;
+    case 7: return dest > src;
+    case 12: return static_cast<ST>(dest) < static_cast<ST>(src);
+    case 13: return static_cast<ST>(dest) >= static_cast<ST>(src);
+    case 14: return static_cast<ST>(dest) <= static_cast<ST>(src);
+    case 15: return static_cast<ST>(dest) > static_cast<ST>(src);
+    default: return evaluate(conditionCode);
+    }
+}
+
 void CPU::haltedLoop()
 {
     while (state() == CPU::Halted) {
-#ifdef HAVE_USLEEP
-        usleep(100);
-#endif
+        runScheduledEvents();
+        if (!machine().scheduler().hasVirtualClock() || !skipToNextScheduledEvent())
+            waitForWakeFromHalt(millisecondsUntilNextScheduledEvent());
         if (m_shouldHardReboot) {
             hardReboot();
             return;
         }
-        if (debugger().isActive()) {
-            saveBaseAddress();
-            debugger().doConsole();
-        }
+        if (m_debuggerRequest != NoDebuggerRequest || debugger().isActive())
+            mainLoopSlowStuff();
         if (PIC::hasPendingIRQ() && getIF())
             PIC::serviceIRQ(*this);
     }
 }
 
+// Device events are run from the CPU thread. Between checks, the main loop only compares cycle counts.
+NEVER_INLINE void CPU::runScheduledEvents()
+{
+    machine().scheduler().runExpiredEvents();
+    m_nextSchedulerCheckCycle = m_cycle + schedulerCheckInterval;
+}
+
+// With a virtual clock, nothing happens while halted until the next event, so time jumps straight there.
+bool CPU::skipToNextScheduledEvent()
+{
+    if (shouldWakeFromHalt())
+        return true;
+    auto& scheduler = machine().scheduler();
+    QWORD deadline = scheduler.nextDeadline();
+    if (deadline == EventScheduler::noDeadline)
+        return false;
+    m_cycle = std::max(m_cycle, scheduler.virtualCycleForDeadline(deadline));
+    return true;
+}
+
+unsigned long CPU::millisecondsUntilNextScheduledEvent() const
+{
+    auto& scheduler = machine().scheduler();
+    QWORD deadline = scheduler.nextDeadline();
+    QWORD now = scheduler.now();
+    if (deadline <= now)
+        return 0;
+    QWORD milliseconds = (deadline - now + 999999) / 1000000;
+    return std::min<QWORD>(milliseconds, haltTimeoutMilliseconds);
+}
+
+bool CPU::shouldWakeFromHalt()
+{
+    if (m_shouldHardReboot || m_debuggerRequest != NoDebuggerRequest || debugger().isActive())
+        return true;
+    return PIC::hasPendingIRQ() && getIF();
+}
+
+// Blocks the CPU thread until wakeFromHalt() is called, or the timeout passes.
+// For HLT, the timeout only serves as a backstop for wakeups we don't know about.
+void CPU::waitForWakeFromHalt(unsigned long timeoutMilliseconds)
+{
+    QMutexLocker locker(&m_haltMutex);
+    m_isWaitingInHalt = true;
+    if (!shouldWakeFromHalt())
+        m_haltCondition.wait(&m_haltMutex, timeoutMilliseconds);
+    m_isWaitingInHalt = false;
+}
+
+// Lots of guest code waits for input or for time to pass by polling (a port, or the BIOS keyboard
+// service) in a tight loop instead of using HLT. A poll from the same instruction as the last one,
+// shortly after it, with the same registers (except the accumulator, which polls overwrite) and
+// no memory written in between, means the loop is getting nowhere.
+// After enough of those in a row, the CPU thread parks until an interrupt or a short timeout.
+void CPU::noteIdlePoll(unsigned allowedMemoryWrites)
+{
+    auto& poll = m_idlePoll;
+    DWORD registers[] = { getEBX(), getECX(), getEDX(), getESP(), getEBP(), getESI(), getEDI() };
+    bool isSamePoll = poll.cs == getBaseCS()
+        && poll.eip == currentBaseInstructionPointer()
+        && m_cycle - poll.cycle <= idlePollMaxCycles
+        && m_memoryWriteCount - poll.memoryWriteCount <= allowedMemoryWrites
+        && !memcmp(poll.registers, registers, sizeof(registers));
+
+    poll.cs = getBaseCS();
+    poll.eip = currentBaseInstructionPointer();
+    poll.cycle = m_cycle;
+    poll.memoryWriteCount = m_memoryWriteCount;
+    memcpy(poll.registers, registers, sizeof(registers));
+
+    if (!isSamePoll) {
+        poll.count = 0;
+        return;
+    }
+    if (poll.count < idlePollThreshold) {
+        ++poll.count;
+        return;
+    }
+    // Parking doesn't move virtual time, so with a virtual clock, time jumps straight to the next
+    // event instead, like in haltedLoop(). The poll is still the same one after the jump.
+    if (machine().scheduler().hasVirtualClock() && skipToNextScheduledEvent()) {
+        poll.cycle = m_cycle;
+        runScheduledEvents();
+        return;
+    }
+#ifdef DEBUG_IDLE_POLLING
+    vlog(LogCPU, "Idle polling at %04x:%08x, parking", poll.cs, poll.eip);
+#endif
+    waitForWakeFromHalt(idlePollTimeoutMilliseconds);
+}
+
+// May be called from any thread, after making whatever change should wake the CPU.
+void CPU::wakeFromHalt()
+{
+    if (!m_isWaitingInHalt)
+        return;
+    QMutexLocker locker(&m_haltMutex);
+    m_haltCondition.wakeAll();
+}
+
 void CPU::queueCommand(Command command)
 {
     switch (command) {
@@ -430,28 +824,31 @@ void CPU::queueCommand(Command command)
         break;
     }
     recomputeMainLoopNeedsSlowStuff();
+    wakeFromHalt();
 }
 
 void CPU::hardReboot()
 {
+    // Cleared first, so that reset() doesn't keep the main loop on the slow path.
+    m_shouldHardReboot = false;
     machine().resetAllIODevices();
     reset();
-    m_shouldHardReboot = false;
 }
 
 void CPU::makeNextInstructionUninterruptible()
 {
-    m_nextInstructionIsUninterruptible = true;
+    setPendingEvent(PendingUninterruptible, true);
 }
 
 void CPU::recomputeMainLoopNeedsSlowStuff()
 {
-    m_mainLoopNeedsSlowStuff = m_debuggerRequest != NoDebuggerRequest ||
-                               m_shouldHardReboot ||
-                               options.trace ||
-                               !m_breakpoints.empty() ||
-                               debugger().isActive() ||
-                               !m_watches.isEmpty();
+    bool needsSlowStuff = m_debuggerRequest != NoDebuggerRequest ||
+                          m_shouldHardReboot ||
+                          options.trace ||
+                          !m_breakpoints.empty() ||
+                          debugger().isActive() ||
+                          !m_watches.isEmpty();
+    setPendingEvent(PendingSlowStuff, needsSlowStuff);
 }
 
 NEVER_INLINE bool CPU::mainLoopSlowStuff()
@@ -496,39 +893,70 @@ NEVER_INLINE bool CPU::mainLoopSlowStuff()
 
 FLATTEN void CPU::mainLoop()
 {
+    if (options.benchmark)
+        m_benchmarkTimer.start();
+
     forever {
-        if (UNLIKELY(m_mainLoopNeedsSlowStuff)) {
-            mainLoopSlowStuff();
+        // Pages invalidated by the last instruction(s) can only be freed once we're out of their blocks.
+        m_instructionCache.collectRetiredPages();
+
+        // Anything that needs to look at the CPU between every instruction (debugger, tracing,
+        // breakpoints, single-stepping) goes through the slow path, one instruction at a time.
+        DWORD pendingEvents = m_pendingEvents;
+        if (UNLIKELY(pendingEvents & (PendingSlowStuff | PendingTrap))) {
+            if (pendingEvents & PendingSlowStuff)
+                mainLoopSlowStuff();
+            executeOneInstruction();
+        } else {
+#if defined(CT_DETERMINISTIC) || defined(SYMBOLIC_TRACING)
+            executeOneInstruction();
+#else
+            switch (executionMode()) {
+            case ExecutionMode::Real:
+                executeBasicBlocks<ExecutionMode::Real>();
+                break;
+            case ExecutionMode::VM86:
+                executeBasicBlocks<ExecutionMode::VM86>();
+                break;
+            case ExecutionMode::Protected16:
+                executeBasicBlocks<ExecutionMode::Protected16>();
+                break;
+            case ExecutionMode::Protected32:
+                executeBasicBlocks<ExecutionMode::Protected32>();
+                break;
+            }
+#endif
         }
 
-        executeOneInstruction();
+        if (UNLIKELY(m_cycle >= m_nextSchedulerCheckCycle))
+            runScheduledEvents();
 
-        // FIXME: An obvious optimization here would be to dispatch next insn directly from whoever put us in this state.
-        // Easy to implement: just call executeOneInstruction() in e.g "POP SS"
-        // I'll do this once things feel more trustworthy in general.
-        if (UNLIKELY(m_nextInstructionIsUninterruptible)) {
-            m_nextInstructionIsUninterruptible = false;
-            continue;
-        }
-
-        if (UNLIKELY(getTF())) {
-            // The Trap Flag is set, so we'll execute one instruction and
-            // call ISR 1 as soon as it's finished.
-            //
-            // This is used by tools like DEBUG to implement step-by-step
-            // execution :-)
-            interrupt(1, InterruptSource::Internal);
+        if (UNLIKELY(m_pendingEvents)) {
+            // FIXME: An obvious optimization here would be to dispatch next insn directly from whoever put us in this state.
+            // Easy to implement: just call executeOneInstruction() in e.g "POP SS"
+            // I'll do this once things feel more trustworthy in general.
+            if (m_pendingEvents & PendingUninterruptible) {
+                setPendingEvent(PendingUninterruptible, false);
+                continue;
+            }
+            servicePendingEvents();
         }
+    }
+}
 
-        if (PIC::hasPendingIRQ() && getIF())
-            PIC::serviceIRQ(*this);
-
-#ifdef CT_DETERMINISTIC
-        if (getIF() && ((cycle() + 1) % 100 == 0)) {
-            machine().pit().raiseIRQ();
-        }
-#endif
+NEVER_INLINE void CPU::servicePendingEvents()
+{
+    if (getTF()) {
+        // The Trap Flag is set, so we'll execute one instruction and
+        // call ISR 1 as soon as it's finished.
+        //
+        // This is used by tools like DEBUG to implement step-by-step
+        // execution :-)
+        interrupt(1, InterruptSource::Internal);
     }
+
+    if ((m_pendingEvents & PendingIRQ) && getIF())
+        PIC::serviceIRQ(*this);
 }
 
 void CPU::jumpRelative8(SIGNED_BYTE displacement)
@@ -639,14 +1067,14 @@ void CPU::protectedModeFarJump(LogicalAddress address, JumpType type, Gate* gate
     auto descriptor = getDescriptor(selector);
 
     if (descriptor.isNull()) {
-        throw GeneralProtectionFault(0, QString("%1 to null selector").arg(toString(type)));
+        throw GeneralProtectionFault(0, "%s to null selector", toString(type));
     }
 
     if (descriptor.isOutsideTableLimits())
-        throw GeneralProtectionFault(selector & 0xfffc, QString("%1 to selector outside table limit").arg(toString(type)));
+        throw GeneralProtectionFault(selector & 0xfffc, "%s to selector outside table limit", toString(type));
 
     if (!descriptor.isCode() && !descriptor.isCallGate() && !descriptor.isTaskGate() && !descriptor.isTSS())
-        throw GeneralProtectionFault(selector & 0xfffc, QString("%1 to invalid descriptor type").arg(toString(type)));
+        throw GeneralProtectionFault(selector & 0xfffc, "%s to invalid descriptor type", toString(type));
 
     if (descriptor.isGate() && gate) {
         dumpDescriptor(*gate);
@@ -670,13 +1098,13 @@ void CPU::protectedModeFarJump(LogicalAddress address, JumpType type, Gate* gate
         }
 
         if (gate.DPL() < getCPL())
-            throw GeneralProtectionFault(selector & 0xfffc, QString("%1 to gate with DPL(%2) < CPL(%3)").arg(toString(type)).arg(gate.DPL()).arg(getCPL()));
+            throw GeneralProtectionFault(selector & 0xfffc, "%s to gate with DPL(%u) < CPL(%u)", toString(type), gate.DPL(), getCPL());
 
         if (selectorRPL > gate.DPL())
-            throw GeneralProtectionFault(selector & 0xfffc, QString("%1 to gate with RPL(%2) > DPL(%3)").arg(toString(type)).arg(selectorRPL).arg(gate.DPL()));
+            throw GeneralProtectionFault(selector & 0xfffc, "%s to gate with RPL(%u) > DPL(%u)", toString(type), selectorRPL, gate.DPL());
 
         if (!gate.present()) {
-            throw NotPresent(selector & 0xfffc, QString("Gate not present"));
+            throw NotPresent(selector & 0xfffc, "Gate not present");
         }
 
         // NOTE: We recurse here, jumping to the gate entry point.
@@ -692,9 +1120,9 @@ void CPU::protectedModeFarJump(LogicalAddress address, JumpType type, Gate* gate
         vlog(LogCPU, "%s to TSS descriptor (%s) -> %08x", toString(type), tssDescriptor.typeName(), tssDescriptor.base());
 #endif
         if (tssDescriptor.DPL() < getCPL())
-            throw GeneralProtectionFault(selector & 0xfffc, QString("%1 to TSS descriptor with DPL < CPL").arg(toString(type)));
+            throw GeneralProtectionFault(selector & 0xfffc, "%s to TSS descriptor with DPL < CPL", toString(type));
         if (tssDescriptor.DPL() < selectorRPL)
-            throw GeneralProtectionFault(selector & 0xfffc, QString("%1 to TSS descriptor with DPL < RPL").arg(toString(type)));
+            throw GeneralProtectionFault(selector & 0xfffc, "%s to TSS descriptor with DPL < RPL", toString(type));
         if (!tssDescriptor.present())
             throw NotPresent(selector & 0xfffc, "TSS not present");
         taskSwitch(tssDescriptor, type);
@@ -707,14 +1135,14 @@ void CPU::protectedModeFarJump(LogicalAddress address, JumpType type, Gate* gate
     if ((type == JumpType::CALL || type == JumpType::JMP) && !gate) {
         if (codeSegment.conforming()) {
             if (codeSegment.DPL() > getCPL()) {
-                throw GeneralProtectionFault(selector & 0xfffc, QString("%1 -> Code segment DPL(%2) > CPL(%3)").arg(toString(type)).arg(codeSegment.DPL()).arg(getCPL()));
+                throw GeneralProtectionFault(selector & 0xfffc, "%s -> Code segment DPL(%u) > CPL(%u)", toString(type), codeSegment.DPL(), getCPL());
             }
         } else {
             if (selectorRPL > codeSegment.DPL()) {
-                throw GeneralProtectionFault(selector & 0xfffc, QString("%1 -> Code segment RPL(%2) > CPL(%3)").arg(toString(type)).arg(selectorRPL).arg(codeSegment.DPL()));
+                throw GeneralProtectionFault(selector & 0xfffc, "%s -> Code segment RPL(%u) > CPL(%u)", toString(type), selectorRPL, codeSegment.DPL());
             }
             if (codeSegment.DPL() != getCPL()) {
-                throw GeneralProtectionFault(selector & 0xfffc, QString("%1 -> Code segment DPL(%2) != CPL(%3)").arg(toString(type)).arg(codeSegment.DPL()).arg(getCPL()));
+                throw GeneralProtectionFault(selector & 0xfffc, "%s -> Code segment DPL(%u) != CPL(%u)", toString(type), codeSegment.DPL(), getCPL());
             }
         }
     }
@@ -730,7 +1158,7 @@ void CPU::protectedModeFarJump(LogicalAddress address, JumpType type, Gate* gate
     }
 
     if (!codeSegment.present()) {
-        throw NotPresent(selector & 0xfffc, QString("Code segment not present"));
+        throw NotPresent(selector & 0xfffc, "Code segment not present");
     }
 
     if (offset > codeSegment.effectiveLimit()) {
@@ -764,7 +1192,7 @@ void CPU::protectedModeFarJump(LogicalAddress address, JumpType type, Gate* gate
         }
 
         if (newSSDescriptor.DPL() != descriptor.DPL()) {
-            throw InvalidTSS(newSS & 0xfffc, QString("New ss DPL(%1) != code segment DPL(%2)").arg(newSSDescriptor.DPL()).arg(descriptor.DPL()));
+            throw InvalidTSS(newSS & 0xfffc, "New ss DPL(%u) != code segment DPL(%u)", newSSDescriptor.DPL(), descriptor.DPL());
         }
 
         if (!newSSDescriptor.isData() || !newSSDescriptor.asDataSegmentDescriptor().writable()) {
@@ -857,7 +1285,7 @@ void CPU::protectedFarReturn(WORD stackAdjustment)
     }
 
     if (selectorRPL < getCPL())
-        throw GeneralProtectionFault(selector & 0xfffc, QString("RETF with RPL(%1) < CPL(%2)").arg(selectorRPL).arg(getCPL()));
+        throw GeneralProtectionFault(selector & 0xfffc, "RETF with RPL(%u) < CPL(%u)", selectorRPL, getCPL());
 
     auto& codeSegment = descriptor.asCodeSegmentDescriptor();
 
@@ -944,7 +1372,7 @@ void CPU::_NOP(Instruction&)
 void CPU::_HLT(Instruction&)
 {
     if (getCPL() != 0) {
-        throw GeneralProtectionFault(0, QString("HLT with CPL!=0(%1)").arg(getCPL()));
+        throw GeneralProtectionFault(0, "HLT with CPL!=0(%u)", getCPL());
     }
 
     setState(CPU::Halted);
@@ -1003,21 +1431,23 @@ void CPU::_XCHG_reg32_RM32(Instruction& insn)
 template<typename T, class Accessor>
 void CPU::doDEC(Accessor accessor)
 {
+    typedef typename TypeDoubler<T>::type DT;
     T value = accessor.get();
-    setOF(value == (T)std::numeric_limits<typename std::make_signed<T>::type>::min());
-    accessor.set(--value);
-    adjustFlag(value, value + 1, 1);
-    updateFlags<T>(value);
+    accessor.set(value - 1);
+    // DEC leaves CF alone, so resolve it against the previous operation before that is forgotten.
+    getCF();
+    setLazyFlags<T>(LazyOperation::Sub, (DT)value - 1, value, 1, Flag::PF | Flag::ZF | Flag::SF | Flag::OF | Flag::AF);
 }
 
 template<typename T, class Accessor>
 void CPU::doINC(Accessor accessor)
 {
+    typedef typename TypeDoubler<T>::type DT;
     T value = accessor.get();
-    setOF(value == (T)std::numeric_limits<typename std::make_signed<T>::type>::max());
-    accessor.set(++value);
-    adjustFlag(value, value - 1, 1);
-    updateFlags<T>(value);
+    accessor.set(value + 1);
+    // INC leaves CF alone, so resolve it against the previous operation before that is forgotten.
+    getCF();
+    setLazyFlags<T>(LazyOperation::Add, (DT)value + 1, value, 1, Flag::PF | Flag::ZF | Flag::SF | Flag::OF | Flag::AF);
 }
 
 void CPU::_DEC_reg16(Instruction& insn)
@@ -1162,9 +1592,152 @@ PhysicalAddress CPU::translateAddress(LinearAddress linearAddress, MemoryAccessT
 {
     if (!getPE() || !getPG())
         return PhysicalAddress(linearAddress.get());
+
+    if (auto* entry = m_tlb.find(linearAddress)) {
+        bool inUserMode = effectiveCPL == 0xff ? getCPL() == 3 : effectiveCPL == 3;
+        if (entry->permits(accessType == MemoryAccessType::Write, inUserMode, getCR0() & CR0::WP))
+            return PhysicalAddress(entry->physicalPage | (linearAddress.get() & 0xfff));
+    }
     return translateAddressSlowCase(linearAddress, accessType, effectiveCPL);
 }
 
+// Finds the physical address of the descriptor at the given linear address, if it's eligible for caching.
+// The translation probes the descriptor's high dword, which is what getDescriptor() reads first,
+// so that a page fault here looks exactly like one from the uncached path.
+bool CPU::descriptorCacheAddress(LinearAddress linearAddress, PhysicalAddress& physicalAddress)
+{
+    if ((linearAddress.get() & 0xfffff000) != (linearAddress.offset(7).get() & 0xfffff000))
+        return false;
+    auto highAddress = translateAddress(linearAddress.offset(4), MemoryAccessType::Read, 0);
+#ifdef A20_ENABLED
+    highAddress.mask(a20Mask());
+#endif
+    physicalAddress = PhysicalAddress(highAddress.get() - 4);
+    return !memoryProviderForAddress(physicalAddress);
+}
+
+// Returns a pointer to the host memory backing a physical page, if there is any.
+// Memory providers only qualify for reading, and only if they allow direct read access.
+BYTE* CPU::hostPageForPhysicalPage(PhysicalAddress physicalPage, bool& isWritable)
+{
+#ifdef A20_ENABLED
+    physicalPage.mask(a20Mask());
+#endif
+    isWritable = false;
+    if (auto* provider = memoryProviderForAddress(physicalPage)) {
+        if (!provider->pointerForDirectReadAccess())
+            return nullptr;
+        DWORD providerOffset = physicalPage.get() - provider->baseAddress().get();
+        if (providerOffset + TLB::pageSize > provider->size())
+            return nullptr;
+        return const_cast<BYTE*>(provider->pointerForDirectReadAccess()) + providerOffset;
+    }
+    if ((QWORD)physicalPage.get() + TLB::pageSize > m_memorySize)
+        return nullptr;
+    isWritable = true;
+    return &m_memory[physicalPage.get()];
+}
+
+void CPU::insertTLBEntry(LinearAddress linearAddress, DWORD physicalPage, BYTE flags)
+{
+    bool isWritable;
+    BYTE* hostPage = hostPageForPhysicalPage(PhysicalAddress(physicalPage & 0xfffff000), isWritable);
+    if (isWritable)
+        flags |= TLB::HostWritable;
+    m_tlb.insert(linearAddress, physicalPage, flags, hostPage);
+}
+
+template<typename T>
+ALWAYS_INLINE BYTE* CPU::hostPointerForFastAccess(LinearAddress linearAddress, MemoryAccessType accessType, BYTE effectiveCPL)
+{
+#ifdef CT_DETERMINISTIC
+    // Every access gets logged in deterministic mode.
+    return nullptr;
+#endif
+#ifdef MEMORY_DEBUGGING
+    if (UNLIKELY(options.memdebug))
+        return nullptr;
+#endif
+    DWORD offsetInPage = linearAddress.get() & (TLB::pageSize - 1);
+    if (offsetInPage > TLB::pageSize - sizeof(T))
+        return nullptr;
+    auto* entry = m_tlb.find(linearAddress);
+    if (!entry || !entry->hostPage)
+        return nullptr;
+    bool isWrite = accessType == MemoryAccessType::Write;
+    if (isWrite) {
+        if (!(entry->flags & TLB::HostWritable))
+            return nullptr;
+        // Writes to pages with cached code or descriptors must invalidate them.
+        DWORD pageIndex = (entry->hostPage - m_memory) / InstructionCache::pageSize;
+        if (m_instructionCache.hasCodeOnPage(pageIndex) || m_descriptorCache.hasDescriptorsOnPage(pageIndex))
+            return nullptr;
+    }
+    if (getPG()) {
+        bool inUserMode = effectiveCPL == 0xff ? getCPL() == 3 : effectiveCPL == 3;
+        if (!entry->permits(isWrite, inUserMode, getCR0() & CR0::WP))
+            return nullptr;
+    }
+    if (isWrite)
+        m_dirtyPages.markDirty((entry->hostPage - m_memory) / InstructionCache::pageSize);
+    return entry->hostPage + offsetInPage;
+}
+
+// With paging disabled, translation is trivial but we still want host pointers for fast access.
+ALWAYS_INLINE void CPU::insertIdentityTLBEntryIfNeeded(LinearAddress linearAddress)
+{
+    if (getPG() || m_tlb.find(linearAddress))
+        return;
+    insertTLBEntry(linearAddress, linearAddress.get(), TLB::UserAccessible | TLB::Writable | TLB::Dirty);
+}
+
+// Returns a host pointer to the string element at segreg:offset if it and the following elements
+// (walking in the direction of DF) can be accessed directly in host memory.
+// `count` is clamped so the chunk stays within one page, the segment limit and the address size.
+// Returns nullptr whenever anything would need the slow path (faults, MMIO, cached code, etc.)
+template<typename T>
+BYTE* CPU::hostPointerForStringChunk(SegmentRegisterIndex segreg, DWORD offset, DWORD& count, MemoryAccessType accessType)
+{
+    auto& descriptor = cachedDescriptor(segreg);
+    QWORD offsetLimit = a32() ? 0xffffffff : 0xffff;
+
+    if (getPE() && !getVM()) {
+        if (descriptor.isNull())
+            return nullptr;
+        if (accessType == MemoryAccessType::Write && (!descriptor.isData() || !descriptor.asDataSegmentDescriptor().writable()))
+            return nullptr;
+        if (accessType == MemoryAccessType::Read && descriptor.isCode() && !descriptor.asCodeSegmentDescriptor().readable())
+            return nullptr;
+        offsetLimit = std::min(offsetLimit, (QWORD)descriptor.effectiveLimit());
+    }
+
+    if ((QWORD)offset + sizeof(T) - 1 > offsetLimit)
+        return nullptr;
+
+    auto linearAddress = descriptor.linearAddress(offset);
+    DWORD offsetInPage = linearAddress.get() & (TLB::pageSize - 1);
+    if (offsetInPage > TLB::pageSize - sizeof(T))
+        return nullptr;
+
+    if (getDF()) {
+        count = std::min(count, offset / (DWORD)sizeof(T) + 1);
+        count = std::min(count, offsetInPage / (DWORD)sizeof(T) + 1);
+    } else {
+        count = std::min(count, (DWORD)((offsetLimit - offset + 1) / sizeof(T)));
+        count = std::min(count, (TLB::pageSize - offsetInPage) / (DWORD)sizeof(T));
+    }
+
+    insertIdentityTLBEntryIfNeeded(linearAddress);
+    auto* pointer = hostPointerForFastAccess<T>(linearAddress, accessType, 0xff);
+    if (pointer && accessType == MemoryAccessType::Write)
+        ++m_memoryWriteCount;
+    return pointer;
+}
+
+template BYTE* CPU::hostPointerForStringChunk<BYTE>(SegmentRegisterIndex, DWORD, DWORD&, MemoryAccessType);
+template BYTE* CPU::hostPointerForStringChunk<WORD>(SegmentRegisterIndex, DWORD, DWORD&, MemoryAccessType);
+template BYTE* CPU::hostPointerForStringChunk<DWORD>(SegmentRegisterIndex, DWORD, DWORD&, MemoryAccessType);
+
 static WORD makePFErrorCode(PageFaultFlags::Flags flags, CPU::MemoryAccessType accessType, bool inUserMode)
 {
     return flags
@@ -1251,14 +1824,29 @@ PhysicalAddress CPU::translateAddressSlowCase(LinearAddress linearAddress, Memor
         }
     }
 
+    // Only write back the Accessed/Dirty bits when they change.
+    DWORD updatedPageDirectoryEntry = pageDirectoryEntry | PageTableEntryFlags::Accessed;
+    DWORD updatedPageTableEntry = pageTableEntry | PageTableEntryFlags::Accessed;
     if (accessType == MemoryAccessType::Write)
-        pageTableEntry |= PageTableEntryFlags::Dirty;
+        updatedPageTableEntry |= PageTableEntryFlags::Dirty;
 
-    pageDirectoryEntry |= PageTableEntryFlags::Accessed;
-    pageTableEntry |= PageTableEntryFlags::Accessed;
+    if (updatedPageDirectoryEntry != pageDirectoryEntry) {
+        pageDirectoryEntry = updatedPageDirectoryEntry;
+        writePhysicalMemory(pdeAddress, pageDirectoryEntry);
+    }
+    if (updatedPageTableEntry != pageTableEntry) {
+        pageTableEntry = updatedPageTableEntry;
+        writePhysicalMemory(pteAddress, pageTableEntry);
+    }
 
-    writePhysicalMemory(pdeAddress, pageDirectoryEntry);
-    writePhysicalMemory(pteAddress, pageTableEntry);
+    BYTE tlbFlags = 0;
+    if (pageDirectoryEntry & pageTableEntry & PageTableEntryFlags::UserSupervisor)
+        tlbFlags |= TLB::UserAccessible;
+    if (pageDirectoryEntry & pageTableEntry & PageTableEntryFlags::ReadWrite)
+        tlbFlags |= TLB::Writable;
+    if (pageTableEntry & PageTableEntryFlags::Dirty)
+        tlbFlags |= TLB::Dirty;
+    insertTLBEntry(linearAddress, pageTableEntry, tlbFlags);
 
     PhysicalAddress physicalAddress((pageTableEntry & 0xfffff000) | offset);
 #ifdef DEBUG_PAGING
@@ -1285,6 +1873,12 @@ void CPU::snoop(SegmentRegisterIndex segreg, DWORD offset, MemoryAccessType acce
 template<typename T>
 ALWAYS_INLINE void CPU::validateAddress(const SegmentDescriptor& descriptor, DWORD offset, MemoryAccessType accessType)
 {
+    BYTE accessBit = 1 << (int)accessType;
+    if (LIKELY(descriptor.m_uncheckedAccess & accessBit))
+        return;
+    if (LIKELY(descriptor.m_permittedAccess & accessBit) && (offset + (sizeof(T) - 1)) <= descriptor.effectiveLimit())
+        return;
+
     if (!getVM()) {
     if (accessType != MemoryAccessType::Execute) {
         if (descriptor.isNull()) {
@@ -1331,7 +1925,7 @@ ALWAYS_INLINE void CPU::validateAddress(const SegmentDescriptor& descriptor, DWO
 #if 0
     // FIXME: Is this appropriate somehow? Need to figure it out. The code below as-is breaks IRET.
     if (getCPL() > descriptor.DPL()) {
-        throw GeneralProtectionFault(0, QString("Insufficient privilege for access (CPL=%1, DPL=%2)").arg(getCPL()).arg(descriptor.DPL()));
+        throw GeneralProtectionFault(0, "Insufficient privilege for access (CPL=%u, DPL=%u)", getCPL(), descriptor.DPL());
     }
 #endif
 
@@ -1368,7 +1962,7 @@ ALWAYS_INLINE bool CPU::validatePhysicalAddress(PhysicalAddress physicalAddress,
     UNUSED_PARAM(accessType);
     if (physicalAddress.get() < m_memorySize)
         return true;
-    return false;
+    return memoryProviderForAddress(physicalAddress);
 }
 
 template<typename T>
@@ -1404,37 +1998,113 @@ void CPU::writePhysicalMemory(PhysicalAddress physicalAddress, T data)
 #endif
         return;
     }
+    DWORD firstPage = physicalAddress.get() / InstructionCache::pageSize;
+    DWORD lastPage = (physicalAddress.get() + sizeof(T) - 1) / InstructionCache::pageSize;
     if (auto* provider = memoryProviderForAddress(physicalAddress)) {
-        provider->write<T>(physicalAddress.get(), data);
+        if (auto* directWriteAccessPointer = provider->pointerForDirectWriteAccess())
+            *reinterpret_cast<T*>(&directWriteAccessPointer[physicalAddress.get() - provider->baseAddress().get()]) = data;
+        else
+            provider->write<T>(physicalAddress.get(), data);
     } else {
         *reinterpret_cast<T*>(&m_memory[physicalAddress.get()]) = data;
+        // Only guest RAM is tracked, a provider mapped over it leaves the RAM itself unchanged.
+        m_dirtyPages.markDirty(firstPage);
+        if (lastPage != firstPage)
+            m_dirtyPages.markDirty(lastPage);
     }
+
+    if (UNLIKELY(m_instructionCache.hasCodeOnPage(firstPage)))
+        m_instructionCache.invalidatePage(firstPage);
+    if (UNLIKELY(lastPage != firstPage && m_instructionCache.hasCodeOnPage(lastPage)))
+        m_instructionCache.invalidatePage(lastPage);
+    if (UNLIKELY(m_descriptorCache.hasDescriptorsOnPage(firstPage)))
+        m_descriptorCache.invalidatePage(firstPage);
+    if (UNLIKELY(lastPage != firstPage && m_descriptorCache.hasDescriptorsOnPage(lastPage)))
+        m_descriptorCache.invalidatePage(lastPage);
 }
 
 template void CPU::writePhysicalMemory<BYTE>(PhysicalAddress, BYTE);
 template void CPU::writePhysicalMemory<WORD>(PhysicalAddress, WORD);
 template void CPU::writePhysicalMemory<DWORD>(PhysicalAddress, DWORD);
 
+// Copies bytes from physical memory, starting at an address and staying within its page.
+void CPU::readPhysicalBytes(PhysicalAddress physicalAddress, BYTE* data, DWORD length)
+{
+    DWORD offsetInPage = physicalAddress.get() & (TLB::pageSize - 1);
+    bool isWritable;
+    if (auto* hostPage = hostPageForPhysicalPage(PhysicalAddress(physicalAddress.get() - offsetInPage), isWritable)) {
+        memcpy(data, hostPage + offsetInPage, length);
+        return;
+    }
+    for (DWORD i = 0; i < length; ++i)
+        data[i] = readPhysicalMemory<BYTE>(PhysicalAddress(physicalAddress.get() + i));
+}
+
+// Copies bytes into physical memory, starting at an address and staying within its page.
+void CPU::writePhysicalBytes(PhysicalAddress physicalAddress, const BYTE* data, DWORD length)
+{
+    DWORD offsetInPage = physicalAddress.get() & (TLB::pageSize - 1);
+    DWORD pageIndex = physicalAddress.get() / TLB::pageSize;
+    bool isWritable;
+    BYTE* hostPage = hostPageForPhysicalPage(PhysicalAddress(physicalAddress.get() - offsetInPage), isWritable);
+    // Pages with cached code or descriptors need writePhysicalMemory() to invalidate them.
+    if (hostPage && isWritable && !m_instructionCache.hasCodeOnPage(pageIndex) && !m_descriptorCache.hasDescriptorsOnPage(pageIndex)) {
+        m_dirtyPages.markDirty(pageIndex);
+        memcpy(hostPage + offsetInPage, data, length);
+        return;
+    }
+    for (DWORD i = 0; i < length; ++i)
+        writePhysicalMemory<BYTE>(PhysicalAddress(physicalAddress.get() + i), data[i]);
+}
+
+// Accesses that straddle two pages with paging enabled translate both pages up front,
+// so that any page fault is raised before memory is touched.
+template<typename T>
+T CPU::readMemorySplit(LinearAddress linearAddress, MemoryAccessType accessType, BYTE effectiveCPL)
+{
+    DWORD firstLength = TLB::pageSize - (linearAddress.get() & (TLB::pageSize - 1));
+    auto firstAddress = translateAddress(linearAddress, accessType, effectiveCPL);
+    auto secondAddress = translateAddress(linearAddress.offset(firstLength), accessType, effectiveCPL);
+#ifdef A20_ENABLED
+    firstAddress.mask(a20Mask());
+    secondAddress.mask(a20Mask());
+#endif
+    BYTE data[sizeof(T)];
+    readPhysicalBytes(firstAddress, data, firstLength);
+    readPhysicalBytes(secondAddress, data + firstLength, sizeof(T) - firstLength);
+    T value;
+    memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+template<typename T>
+void CPU::writeMemorySplit(LinearAddress linearAddress, T value, BYTE effectiveCPL)
+{
+    DWORD firstLength = TLB::pageSize - (linearAddress.get() & (TLB::pageSize - 1));
+    auto firstAddress = translateAddress(linearAddress, MemoryAccessType::Write, effectiveCPL);
+    auto secondAddress = translateAddress(linearAddress.offset(firstLength), MemoryAccessType::Write, effectiveCPL);
+#ifdef A20_ENABLED
+    firstAddress.mask(a20Mask());
+    secondAddress.mask(a20Mask());
+#endif
+    BYTE data[sizeof(T)];
+    memcpy(data, &value, sizeof(T));
+    writePhysicalBytes(firstAddress, data, firstLength);
+    writePhysicalBytes(secondAddress, data + firstLength, sizeof(T) - firstLength);
+}
+
 template<typename T>
 ALWAYS_INLINE T CPU::readMemory(LinearAddress linearAddress, MemoryAccessType accessType, BYTE effectiveCPL)
 {
-    // FIXME: This needs to be optimized.
-    if constexpr (sizeof(T) == 4) {
-        if (getPG() && (linearAddress.get() & 0xfffff000) != (((linearAddress.get() + (sizeof(T) - 1)) & 0xfffff000))) {
-            BYTE b1 = readMemory<BYTE>(linearAddress.offset(0), accessType, effectiveCPL);
-            BYTE b2 = readMemory<BYTE>(linearAddress.offset(1), accessType, effectiveCPL);
-            BYTE b3 = readMemory<BYTE>(linearAddress.offset(2), accessType, effectiveCPL);
-            BYTE b4 = readMemory<BYTE>(linearAddress.offset(3), accessType, effectiveCPL);
-            return weld<DWORD>(weld<WORD>(b4, b3), weld<WORD>(b2, b1));
-        }
-    } else if constexpr (sizeof(T) == 2) {
-        if (getPG() && (linearAddress.get() & 0xfffff000) != (((linearAddress.get() + (sizeof(T) - 1)) & 0xfffff000))) {
-            BYTE b1 = readMemory<BYTE>(linearAddress.offset(0), accessType, effectiveCPL);
-            BYTE b2 = readMemory<BYTE>(linearAddress.offset(1), accessType, effectiveCPL);
-            return weld<WORD>(b2, b1);
-        }
+    if (auto* hostPointer = hostPointerForFastAccess<T>(linearAddress, accessType, effectiveCPL))
+        return *reinterpret_cast<const T*>(hostPointer);
+
+    if constexpr (sizeof(T) > 1) {
+        if (getPG() && (linearAddress.get() & 0xfffff000) != (((linearAddress.get() + (sizeof(T) - 1)) & 0xfffff000)))
+            return readMemorySplit<T>(linearAddress, accessType, effectiveCPL);
     }
 
+    insertIdentityTLBEntryIfNeeded(linearAddress);
     auto physicalAddress = translateAddress(linearAddress, accessType, effectiveCPL);
 #ifdef A20_ENABLED
     physicalAddress.mask(a20Mask());
@@ -1516,23 +2186,20 @@ template LogicalAddress CPU::readLogicalAddress<DWORD>(SegmentRegisterIndex, DWO
 template<typename T>
 void CPU::writeMemory(LinearAddress linearAddress, T value, BYTE effectiveCPL)
 {
-    // FIXME: This needs to be optimized.
-    if constexpr (sizeof(T) == 4) {
-        if (getPG() && (linearAddress.get() & 0xfffff000) != (((linearAddress.get() + (sizeof(T) - 1)) & 0xfffff000))) {
-            writeMemory<BYTE>(linearAddress.offset(0), value & 0xff, effectiveCPL);
-            writeMemory<BYTE>(linearAddress.offset(1), (value >> 8) & 0xff , effectiveCPL);
-            writeMemory<BYTE>(linearAddress.offset(2), (value >> 16) & 0xff, effectiveCPL);
-            writeMemory<BYTE>(linearAddress.offset(3), (value >> 24) & 0xff, effectiveCPL);
-            return;
-        }
-    } else if constexpr (sizeof(T) == 2) {
+    ++m_memoryWriteCount;
+    if (auto* hostPointer = hostPointerForFastAccess<T>(linearAddress, MemoryAccessType::Write, effectiveCPL)) {
+        *reinterpret_cast<T*>(hostPointer) = value;
+        return;
+    }
+
+    if constexpr (sizeof(T) > 1) {
         if (getPG() && (linearAddress.get() & 0xfffff000) != (((linearAddress.get() + (sizeof(T) - 1)) & 0xfffff000))) {
-            writeMemory<BYTE>(linearAddress.offset(0), value & 0xff, effectiveCPL);
-            writeMemory<BYTE>(linearAddress.offset(1), (value >> 8) & 0xff , effectiveCPL);
+            writeMemorySplit<T>(linearAddress, value, effectiveCPL);
             return;
         }
     }
 
+    insertIdentityTLBEntryIfNeeded(linearAddress);
     auto physicalAddress = translateAddress(linearAddress, MemoryAccessType::Write, effectiveCPL);
 #ifdef A20_ENABLED
     physicalAddress.mask(a20Mask());
@@ -1610,7 +2277,8 @@ void CPU::updateStackSize()
 
 void CPU::updateCodeSegmentCache()
 {
-    // FIXME: We need some kind of fast pointer for fetching from CS:EIP.
+    // Block links assume that CS and the linear->physical mapping are unchanged.
+    m_instructionCache.invalidateLinks();
 }
 
 void CPU::setCS(WORD value)
@@ -1682,11 +2350,181 @@ const BYTE* CPU::memoryPointer(LinearAddress linearAddress)
 template<typename T>
 ALWAYS_INLINE T CPU::readInstructionStream()
 {
-    T data = readMemory<T>(SegmentRegisterIndex::CS, currentInstructionPointer(), MemoryAccessType::Execute);
+    DWORD offset = currentInstructionPointer();
+    if (offset < m_fetchWindow.start || (QWORD)offset + sizeof(T) > m_fetchWindow.end)
+        refillFetchWindow(offset);
+
+    T data;
+    if (LIKELY((QWORD)offset + sizeof(T) <= m_fetchWindow.end)) {
+        memcpy(&data, m_fetchWindow.data + (offset - m_fetchWindow.start), sizeof(T));
+    } else {
+        // Fetches that run off the window (page or limit boundary, MMIO, TLB miss) take the slow path,
+        // which also takes care of raising #PF/#GP exactly like it always has.
+        data = readMemory<T>(SegmentRegisterIndex::CS, offset, MemoryAccessType::Execute);
+    }
     adjustInstructionPointer(sizeof(T));
     return data;
 }
 
+// Points the fetch window at up to maxInstructionLength bytes of host memory starting at CS:offset,
+// stopping at the end of the page and the code segment. Leaves it empty if that's not possible.
+void CPU::refillFetchWindow(DWORD offset)
+{
+    m_fetchWindow = FetchWindow();
+    m_fetchWindow.start = offset;
+    m_fetchWindow.end = offset;
+
+    QWORD available = std::min<QWORD>(codeSegmentBytesAvailableFrom(offset), maxInstructionLength);
+    if (!available)
+        return;
+    auto linearAddress = cachedDescriptor(SegmentRegisterIndex::CS).linearAddress(offset);
+    available = std::min<QWORD>(available, TLB::pageSize - (linearAddress.get() & (TLB::pageSize - 1)));
+
+    insertIdentityTLBEntryIfNeeded(linearAddress);
+    auto* hostPointer = hostPointerForFastAccess<BYTE>(linearAddress, MemoryAccessType::Execute, 0xff);
+    if (!hostPointer)
+        return;
+    m_fetchWindow.data = hostPointer;
+    m_fetchWindow.end = offset + available;
+}
+
+PhysicalAddress CPU::currentInstructionPhysicalAddress()
+{
+    // Resolve CS:EIP exactly like the first byte fetch would, so that faults are identical.
+    auto& codeSegment = cachedDescriptor(SegmentRegisterIndex::CS);
+    DWORD offset = currentInstructionPointer();
+    if (getPE() && !getVM())
+        validateAddress<BYTE>(codeSegment, offset, MemoryAccessType::Execute);
+    auto physicalAddress = translateAddress(codeSegment.linearAddress(offset), MemoryAccessType::Execute);
+#ifdef A20_ENABLED
+    physicalAddress.mask(a20Mask());
+#endif
+    return physicalAddress;
+}
+
+// Bytes that can be fetched from CS:offset onward without wrapping around or hitting the limit.
+QWORD CPU::codeSegmentBytesAvailableFrom(DWORD offset)
+{
+    QWORD end = x32() ? 0x100000000 : 0x10000;
+    if (getPE() && !getVM())
+        end = std::min(end, (QWORD)cachedDescriptor(SegmentRegisterIndex::CS).effectiveLimit() + 1);
+    return end > offset ? end - offset : 0;
+}
+
+const Instruction* CPU::cachedInstructionAtCurrentInstructionPointer(PhysicalAddress& physicalAddress)
+{
+    physicalAddress = currentInstructionPhysicalAddress();
+
+    auto* insn = m_instructionCache.get(physicalAddress, m_operandSize32, m_addressSize32);
+    if (!insn)
+        return nullptr;
+
+    // Let the regular decoder deal with wrap-arounds and limit violations.
+    if (insn->length() > codeSegmentBytesAvailableFrom(currentInstructionPointer()))
+        return nullptr;
+    return insn;
+}
+
+template<CPU::ExecutionMode mode>
+ALWAYS_INLINE PhysicalAddress CPU::currentInstructionPhysicalAddress()
+{
+    auto& codeSegment = cachedDescriptor(SegmentRegisterIndex::CS);
+    DWORD offset = currentInstructionPointer();
+    if constexpr (mode == ExecutionMode::Protected16 || mode == ExecutionMode::Protected32)
+        validateAddress<BYTE>(codeSegment, offset, MemoryAccessType::Execute);
+    // Paging can't be enabled without protection.
+    PhysicalAddress physicalAddress;
+    if constexpr (mode == ExecutionMode::Real)
+        physicalAddress = PhysicalAddress(codeSegment.linearAddress(offset).get());
+    else
+        physicalAddress = translateAddress(codeSegment.linearAddress(offset), MemoryAccessType::Execute);
+#ifdef A20_ENABLED
+    physicalAddress.mask(a20Mask());
+#endif
+    return physicalAddress;
+}
+
+template<CPU::ExecutionMode mode>
+ALWAYS_INLINE QWORD CPU::codeSegmentBytesAvailableFrom(DWORD offset)
+{
+    QWORD end;
+    if constexpr (mode == ExecutionMode::Real)
+        end = x32() ? 0x100000000 : 0x10000;
+    else if constexpr (mode == ExecutionMode::VM86)
+        end = 0x10000;
+    else
+        end = std::min<QWORD>(mode == ExecutionMode::Protected32 ? 0x100000000 : 0x10000, (QWORD)cachedDescriptor(SegmentRegisterIndex::CS).effectiveLimit() + 1);
+    return end > offset ? end - offset : 0;
+}
+
+template<CPU::ExecutionMode mode>
+ALWAYS_INLINE BasicBlock* CPU::basicBlockAtCurrentInstructionPointer()
+{
+    auto physicalAddress = currentInstructionPhysicalAddress<mode>();
+    DWORD offset = currentInstructionPointer();
+
+    // A real mode CS may still be 32-bit after leaving protected mode, but VM86 code segments never are.
+    BasicBlock* block;
+    if constexpr (mode == ExecutionMode::Real)
+        block = m_instructionCache.getBlock(physicalAddress, m_operandSize32, m_addressSize32);
+    else
+        block = m_instructionCache.getBlock(physicalAddress, mode == ExecutionMode::Protected32, mode == ExecutionMode::Protected32);
+
+    if (block) {
+        // The same code may be reachable through a segment with a lower limit.
+        if (block->length > codeSegmentBytesAvailableFrom<mode>(offset))
+            return nullptr;
+        return block;
+    }
+    return buildBasicBlock(physicalAddress, offset);
+}
+
+BasicBlock* CPU::buildBasicBlock(PhysicalAddress physicalAddress, DWORD offset)
+{
+    if (!validatePhysicalAddress<BYTE>(physicalAddress, MemoryAccessType::Execute))
+        return nullptr;
+
+    // Blocks are decoded straight out of host memory, so only RAM and ROM will do.
+    DWORD pageOffset = physicalAddress.get() & (InstructionCache::pageSize - 1);
+    QWORD available = InstructionCache::pageSize - pageOffset;
+    const BYTE* code;
+    if (auto* provider = memoryProviderForAddress(physicalAddress)) {
+        if (!provider->pointerForDirectReadAccess())
+            return nullptr;
+        DWORD providerOffset = physicalAddress.get() - provider->baseAddress().get();
+        code = provider->pointerForDirectReadAccess() + providerOffset;
+        available = std::min<QWORD>(available, provider->size() - providerOffset);
+    } else {
+        code = &m_memory[physicalAddress.get()];
+        available = std::min<QWORD>(available, m_memorySize - physicalAddress.get());
+    }
+    available = std::min(available, codeSegmentBytesAvailableFrom(offset));
+
+    // Instructions that straddle the end of what we can see, or don't decode, are left
+    // to the regular decoder so that they fault exactly like they should.
+    BoundedInstructionStream stream(code, available);
+    auto* block = new BasicBlock(m_operandSize32, m_addressSize32);
+    while (block->instructions.size() < BasicBlock::maxInstructions) {
+        auto insn = Instruction::fromStream(stream, m_operandSize32, m_addressSize32);
+        if (stream.hasOverrun() || !insn.isValid())
+            break;
+        block->instructions.push_back(insn);
+        block->length += insn.length();
+        if (insn.endsBasicBlock())
+            break;
+    }
+
+    // Traces for the autotests must see every instruction on its own.
+    auto& instructions = block->instructions;
+    if (!m_isForAutotest && instructions.size() >= 2)
+        block->fusion = instructions[instructions.size() - 2].fusionWithBranch(instructions.back());
+
+#ifdef DEBUG_BASIC_BLOCKS
+    vlog(LogCPU, "Built block of %zu instruction(s) at %04x:%08x (physical %08x)", block->instructions.size(), getCS(), offset, physicalAddress.get());
+#endif
+    return m_instructionCache.addBlock(physicalAddress, block);
+}
+
 BYTE CPU::readInstruction8()
 {
     return readInstructionStream<BYTE>();
@@ -1767,22 +2605,29 @@ void CPU::initWatches()
 
 void CPU::registerMemoryProvider(MemoryProvider& provider)
 {
-    if ((provider.baseAddress().get() + provider.size()) > 1048576) {
-        vlog(LogConfig, "Can't register mapper with length %u @ %08x", provider.size(), provider.baseAddress().get());
+    DWORD base = provider.baseAddress().get();
+    QWORD end = (QWORD)base + provider.size();
+    if ((base % memoryProviderPageSize) || end > 0x100000000ull) {
+        vlog(LogConfig, "Can't register mapper with length %u @ %08x", provider.size(), base);
         ASSERT_NOT_REACHED();
     }
 
-    for (unsigned i = provider.baseAddress().get() / memoryProviderBlockSize; i < (provider.baseAddress().get() + provider.size()) / memoryProviderBlockSize; ++i) {
-        vlog(LogConfig, "Register memory provider %p as mapper %u", &provider, i);
-        m_memoryProviders[i] = &provider;
+    vlog(LogConfig, "Register memory provider %p for %08x-%08llx", &provider, base, (unsigned long long)end - 1);
+    for (QWORD address = base; address < end; address += memoryProviderPageSize) {
+        auto& table = m_memoryProviderMap[address / (memoryProviderPageSize * memoryProviderPagesPerTable)];
+        if (!table)
+            table = make<MemoryProviderTable>();
+        table->providers[(address / memoryProviderPageSize) % memoryProviderPagesPerTable] = &provider;
     }
+    flushTLB();
 }
 
 ALWAYS_INLINE MemoryProvider* CPU::memoryProviderForAddress(PhysicalAddress address)
 {
-    if (address.get() >= 1048576)
+    auto& table = m_memoryProviderMap[address.get() / (memoryProviderPageSize * memoryProviderPagesPerTable)];
+    if (LIKELY(!table))
         return nullptr;
-    return m_memoryProviders[address.get() / memoryProviderBlockSize];
+    return table->providers[(address.get() / memoryProviderPageSize) % memoryProviderPagesPerTable];
 }
 
 template<typename T>
@@ -1804,7 +2649,7 @@ void CPU::doBOUND(Instruction& insn)
         isWithinBounds ? "yes" : "no");
 #endif
     if (!isWithinBounds)
-        throw BoundRangeExceeded(QString("%1 not within [%2, %3]").arg(arrayIndex).arg(lowerBound).arg(upperBound));
+        throw BoundRangeExceeded("%d not within [%d, %d]", arrayIndex, lowerBound, upperBound);
 }
 
 void CPU::_BOUND(Instruction& insn)
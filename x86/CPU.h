@@ -26,16 +26,26 @@
 
 #include "Common.h"
 #include "debug.h"
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QMutex>
+#include <QtCore/QWaitCondition>
 #include <QtCore/QVector>
 #include <set>
 #include "OwnPtr.h"
 #include "Instruction.h"
+#include "InstructionCache.h"
+#include "DescriptorCache.h"
+#include "DirtyPageBitmap.h"
+#include "TLB.h"
 #include "Descriptor.h"
 
 class Debugger;
 class Machine;
 class MemoryProvider;
 class CPU;
+class QDataStream;
+class QFile;
+class QIODevice;
 class TSS;
 
 struct WatchedAddress {
@@ -76,9 +86,13 @@ enum Flags {
 
 struct HardwareInterruptDuringREP { };
 
+// Faults are delivered by throwing one of these. It holds no QString, so raising one doesn't
+// build any text, but the throw itself still goes through the C++ runtime's exception allocation.
+// The reason is a static printf-style format string; it's only formatted (by the CPU's fault
+// functions) when exception logging is enabled.
 class Exception {
 public:
-    Exception(BYTE num, WORD code, DWORD address, const QString& reason)
+    Exception(BYTE num, WORD code, DWORD address, const char* reason)
         : m_num(num)
         , m_code(code)
         , m_address(address)
@@ -87,7 +101,7 @@ public:
     {
     }
 
-    Exception(BYTE num, WORD code, const QString& reason)
+    Exception(BYTE num, WORD code, const char* reason)
         : m_num(num)
         , m_code(code)
         , m_hasCode(true)
@@ -95,27 +109,25 @@ public:
     {
     }
 
-    Exception(BYTE num, const QString& reason)
+    Exception(BYTE num, const char* reason)
         : m_num(num)
         , m_hasCode(false)
         , m_reason(reason)
     {
     }
 
-    ~Exception() { }
-
     BYTE num() const { return m_num; }
     WORD code() const { return m_code; }
     bool hasCode() const { return m_hasCode; }
     DWORD address() const { return m_address; }
-    QString reason() const { return m_reason; }
+    const char* reason() const { return m_reason; }
 
 private:
     BYTE m_num { 0 };
     WORD m_code { 0 };
     DWORD m_address { 0 };
     bool m_hasCode { false };
-    QString m_reason;
+    const char* m_reason { nullptr };
 };
 
 union PartAddressableRegister {
@@ -224,18 +236,53 @@ public:
     void registerMemoryProvider(MemoryProvider&);
     MemoryProvider* memoryProviderForAddress(PhysicalAddress);
 
+    // Which pages of guest RAM have been written since they were last collected.
+    DirtyPageBitmap& dirtyPages() { return m_dirtyPages; }
+
     void recomputeMainLoopNeedsSlowStuff();
 
+    // Everything the main loop has to look at between blocks, so the common case tests one word.
+    // Bits may be set from other threads (e.g PendingIRQ by devices.)
+    enum PendingEvent : DWORD {
+        PendingSlowStuff = 1u << 0,
+        PendingUninterruptible = 1u << 1,
+        PendingTrap = 1u << 2,
+        PendingIRQ = 1u << 3,
+    };
+    void setPendingEvent(PendingEvent event, bool value)
+    {
+        if (((m_pendingEvents.load(std::memory_order_relaxed) & event) != 0) == value)
+            return;
+        if (value)
+            m_pendingEvents.fetch_or(event);
+        else
+            m_pendingEvents.fetch_and(~event);
+    }
+
     QWORD cycle() const { return m_cycle; }
 
     void reset();
 
+    // For Machine::saveState(). Guest RAM is kept apart from the rest, see saveMemory().
+    void saveState(QDataStream&) const;
+    void restoreState(QDataStream&);
+    bool saveMemory(QIODevice&) const;
+    // Restoring RAM is split in two so Machine::restoreState() can validate everything before touching the CPU:
+    // loadMemoryImage() returns a new mapping (or nullptr), which is then either adopted or discarded.
+    static BYTE* loadMemoryImage(QFile&, DWORD size);
+    static void discardMemoryImage(BYTE*, DWORD size);
+    void adoptMemoryImage(BYTE*, DWORD size);
+    DWORD memorySize() const { return m_memorySize; }
+
     Machine& machine() const { return m_machine; }
 
     std::set<LogicalAddress>& breakpoints() { return m_breakpoints; }
 
     enum class MemoryAccessType { Read, Write, Execute, InternalPointer };
 
+    // The main loop runs a separate instance of the basic block loop for each of these.
+    enum class ExecutionMode : BYTE { Real, VM86, Protected16, Protected32 };
+
     enum RegisterIndex8 {
         RegisterAL = 0,
         RegisterCL,
@@ -318,6 +365,7 @@ public:
     SegmentDescriptor getSegmentDescriptor(WORD selector);
     Descriptor getInterruptDescriptor(BYTE number);
     Descriptor getDescriptor(DescriptorTableRegister&, WORD index, bool indexIsSelector);
+    bool descriptorCacheAddress(LinearAddress, PhysicalAddress&);
 
     SegmentRegisterIndex currentSegment() const { return m_segmentPrefix == SegmentRegisterIndex::None ? SegmentRegisterIndex::DS : m_segmentPrefix; }
     bool hasSegmentPrefix() const { return m_segmentPrefix != SegmentRegisterIndex::None; }
@@ -346,7 +394,7 @@ public:
 
     void kill();
 
-    void setA20Enabled(bool value) { m_a20Enabled = value; }
+    void setA20Enabled(bool value) { m_a20Enabled = value; m_tlb.flush(); m_instructionCache.invalidateLinks(); }
     bool isA20Enabled() const { return m_a20Enabled; }
 
     DWORD a20Mask() const { return isA20Enabled() ? 0xFFFFFFFF : 0xFFEFFFFF; }
@@ -363,24 +411,24 @@ public:
     void iretFromVM86Mode();
     void iretFromRealMode();
 
-    Exception GeneralProtectionFault(WORD selector, const QString& reason);
-    Exception StackFault(WORD selector, const QString& reason);
-    Exception NotPresent(WORD selector, const QString& reason);
-    Exception InvalidTSS(WORD selector, const QString& reason);
+    Exception GeneralProtectionFault(WORD selector, const char* reason, ...) PRINTF_FORMAT(3, 4);
+    Exception StackFault(WORD selector, const char* reason, ...) PRINTF_FORMAT(3, 4);
+    Exception NotPresent(WORD selector, const char* reason, ...) PRINTF_FORMAT(3, 4);
+    Exception InvalidTSS(WORD selector, const char* reason, ...) PRINTF_FORMAT(3, 4);
     Exception PageFault(LinearAddress, PageFaultFlags::Flags, MemoryAccessType, bool inUserMode, const char* faultTable, DWORD pde, DWORD pte = 0);
-    Exception DivideError(const QString& reason);
-    Exception InvalidOpcode(const QString& reason = QString());
-    Exception BoundRangeExceeded(const QString& reason);
+    Exception DivideError(const char* reason, ...) PRINTF_FORMAT(2, 3);
+    Exception InvalidOpcode(const char* reason = "Invalid opcode", ...) PRINTF_FORMAT(2, 3);
+    Exception BoundRangeExceeded(const char* reason, ...) PRINTF_FORMAT(2, 3);
 
     void raiseException(const Exception&);
 
     void setIF(bool value) { this->IF = value; }
-    void setCF(bool value) { this->CF = value; }
+    void setCF(bool value) { m_dirtyFlags &= ~Flag::CF; this->CF = value; }
     void setDF(bool value) { this->DF = value; }
     void setSF(bool value) { m_dirtyFlags &= ~Flag::SF; this->SF = value; }
-    void setAF(bool value) { this->AF = value; }
-    void setTF(bool value) { this->TF = value; }
-    void setOF(bool value) { this->OF = value; }
+    void setAF(bool value) { m_dirtyFlags &= ~Flag::AF; this->AF = value; }
+    void setTF(bool value) { this->TF = value; setPendingEvent(PendingTrap, value); }
+    void setOF(bool value) { m_dirtyFlags &= ~Flag::OF; this->OF = value; }
     void setPF(bool value) { m_dirtyFlags &= ~Flag::PF; this->PF = value; }
     void setZF(bool value) { m_dirtyFlags &= ~Flag::ZF; this->ZF = value; }
     void setVIF(bool value) { this->VIF = value; }
@@ -390,12 +438,12 @@ public:
     void setIOPL(unsigned int value) { this->IOPL = value; }
 
     bool getIF() const { return this->IF; }
-    bool getCF() const { return this->CF; }
+    bool getCF() const;
     bool getDF() const { return this->DF; }
     bool getSF() const;
-    bool getAF() const { return this->AF; }
+    bool getAF() const;
     bool getTF() const { return this->TF; }
-    bool getOF() const { return this->OF; }
+    bool getOF() const;
     bool getPF() const;
     bool getZF() const;
 
@@ -580,13 +628,20 @@ public:
     void execute(Instruction&);
 
     void executeOneInstruction();
+    template<ExecutionMode> void executeBasicBlocks();
 
     // CPU main loop - will fetch & decode until stopped
     void mainLoop();
     bool mainLoopSlowStuff();
+    void servicePendingEvents();
 
     // CPU main loop when halted (HLT) - will do nothing until an IRQ is raised
     void haltedLoop();
+    bool shouldWakeFromHalt();
+    void waitForWakeFromHalt(unsigned long timeoutMilliseconds);
+    void runScheduledEvents();
+    bool skipToNextScheduledEvent();
+    unsigned long millisecondsUntilNextScheduledEvent() const;
 
     void push32(DWORD value);
     DWORD pop32();
@@ -634,10 +689,8 @@ public:
     template<typename T> void mathFlags(typename TypeDoubler<T>::type result, T dest, T src);
     template<typename T> void cmpFlags(typename TypeDoubler<T>::type result, T dest, T src);
 
-    void adjustFlag(QWORD result, DWORD src, DWORD dest)
-    {
-        setAF((((result ^ (src ^ dest)) & 0x10) >> 4) & 1);
-    }
+    enum class LazyOperation : BYTE { Add, Sub };
+    template<typename T> void setLazyFlags(LazyOperation, typename TypeDoubler<T>::type result, T dest, T src, DWORD flags);
 
     template<typename T> T readRegister(int registerIndex) const;
     template<typename T> void writeRegister(int registerIndex, T value);
@@ -663,6 +716,10 @@ public:
     template<typename T> void writeMemory(LinearAddress, T, BYTE effectiveCPL = 0xff);
     template<typename T> void writeMemory(const SegmentDescriptor&, DWORD offset, T);
     template<typename T> void writeMemory(SegmentRegisterIndex, DWORD offset, T);
+    template<typename T> T readMemorySplit(LinearAddress, MemoryAccessType, BYTE effectiveCPL);
+    template<typename T> void writeMemorySplit(LinearAddress, T, BYTE effectiveCPL);
+    void readPhysicalBytes(PhysicalAddress, BYTE*, DWORD length);
+    void writePhysicalBytes(PhysicalAddress, const BYTE*, DWORD length);
 
     PhysicalAddress translateAddress(LinearAddress, MemoryAccessType, BYTE effectiveCPL = 0xff);
     void snoop(LinearAddress, MemoryAccessType);
@@ -726,6 +783,15 @@ public:
     bool x16() const { return !x32(); }
     bool x32() const { return cachedDescriptor(SegmentRegisterIndex::CS).D(); }
 
+    ExecutionMode executionMode() const
+    {
+        if (!getPE())
+            return ExecutionMode::Real;
+        if (getVM())
+            return ExecutionMode::VM86;
+        return x32() ? ExecutionMode::Protected32 : ExecutionMode::Protected16;
+    }
+
     bool a16() const { return !m_effectiveAddressSize32; }
     bool a32() const { return m_effectiveAddressSize32; }
     bool o16() const { return !m_effectiveOperandSize32; }
@@ -736,6 +802,8 @@ public:
 
     enum Command { ExitDebugger, EnterDebugger, HardReboot };
     void queueCommand(Command);
+    void wakeFromHalt();
+    void noteIdlePoll(unsigned allowedMemoryWrites = 0);
 
     static const char* registerName(CPU::RegisterIndex8) PURE;
     static const char* registerName(CPU::RegisterIndex16) PURE;
@@ -817,6 +885,7 @@ protected:
     void _XCHG_reg32_RM32(Instruction&);
 
     template<typename F> void doOnceOrRepeatedly(Instruction&, bool careAboutZF, F);
+    template<typename F, typename BulkF> void doOnceOrRepeatedly(Instruction&, bool careAboutZF, F, BulkF);
     template<typename T> void doLODS(Instruction&);
     template<typename T> void doSTOS(Instruction&);
     template<typename T> void doMOVS(Instruction&);
@@ -1316,10 +1385,24 @@ private:
     friend class InstructionExecutionContext;
 
     template<typename T> T readInstructionStream();
+    void refillFetchWindow(DWORD offset);
     BYTE readInstruction8() override;
     WORD readInstruction16() override;
     DWORD readInstruction32() override;
 
+    PhysicalAddress currentInstructionPhysicalAddress();
+    template<ExecutionMode> PhysicalAddress currentInstructionPhysicalAddress();
+    QWORD codeSegmentBytesAvailableFrom(DWORD offset);
+    template<ExecutionMode> QWORD codeSegmentBytesAvailableFrom(DWORD offset);
+    const Instruction* cachedInstructionAtCurrentInstructionPointer(PhysicalAddress&);
+    template<ExecutionMode> BasicBlock* basicBlockAtCurrentInstructionPointer();
+    BasicBlock* buildBasicBlock(PhysicalAddress, DWORD offset);
+    bool executeBasicBlock(BasicBlock&);
+    bool executeInstructionInBlock(Instruction&, QWORD generation);
+    void executeFusedPair(Instruction&, Instruction& branch, Instruction::Fusion);
+    template<typename T> bool executeFusedHead(Instruction&, Instruction::Fusion, BYTE conditionCode);
+    bool canChainBasicBlocks() const;
+
     void initWatches();
     void hardReboot();
 
@@ -1329,6 +1412,12 @@ private:
     void makeNextInstructionUninterruptible();
 
     PhysicalAddress translateAddressSlowCase(LinearAddress, MemoryAccessType, BYTE effectiveCPL);
+    void flushTLB() { m_tlb.flush(); }
+    void insertTLBEntry(LinearAddress, DWORD physicalPage, BYTE flags);
+    void insertIdentityTLBEntryIfNeeded(LinearAddress);
+    BYTE* hostPageForPhysicalPage(PhysicalAddress, bool& isWritable);
+    template<typename T> BYTE* hostPointerForFastAccess(LinearAddress, MemoryAccessType, BYTE effectiveCPL);
+    template<typename T> BYTE* hostPointerForStringChunk(SegmentRegisterIndex, DWORD offset, DWORD& count, MemoryAccessType);
 
     template<typename T> T doSAR(T, unsigned steps);
     template<typename T> T doRCL(T, unsigned steps);
@@ -1374,6 +1463,7 @@ private:
 
     void dumpSelector(const char* prefix, SegmentRegisterIndex);
     void writeSegmentRegister(SegmentRegisterIndex, WORD selector);
+    void updateSegmentAccessCache(SegmentDescriptor&);
     void validateSegmentLoad(SegmentRegisterIndex, WORD selector, const Descriptor&);
 
     SegmentDescriptor m_descriptor[6];
@@ -1428,17 +1518,27 @@ private:
     std::set<LogicalAddress> m_breakpoints;
 
     bool m_a20Enabled { false };
-    bool m_nextInstructionIsUninterruptible { false };
 
     OwnPtr<Debugger> m_debugger;
 
-    // One MemoryProvider* per 'memoryProviderBlockSize' bytes for the first MB of memory.
-    static const size_t memoryProviderBlockSize = 16384;
-    MemoryProvider* m_memoryProviders[1048576 / memoryProviderBlockSize];
+    // The physical memory map: one MemoryProvider* per page, covering the whole 4 GB address space
+    // in two levels. Tables only exist for 4 MB regions where something is registered, so plain RAM
+    // with nothing behind it is found to have no provider with a single lookup.
+    static const DWORD memoryProviderPageSize = 4096;
+    static const DWORD memoryProviderPagesPerTable = 1024;
+    struct MemoryProviderTable {
+        MemoryProvider* providers[memoryProviderPagesPerTable] { };
+    };
+    OwnPtr<MemoryProviderTable> m_memoryProviderMap[0x100000000ull / (memoryProviderPageSize * memoryProviderPagesPerTable)];
 
     BYTE* m_memory { nullptr };
     size_t m_memorySize { 0 };
 
+    InstructionCache m_instructionCache;
+    DescriptorCache m_descriptorCache;
+    DirtyPageBitmap m_dirtyPages;
+    TLB m_tlb;
+
     WORD* m_segmentMap[8];
     DWORD* m_controlRegisterMap[8];
     DWORD* m_debugRegisterMap[8];
@@ -1453,10 +1553,30 @@ private:
 
     enum DebuggerRequest { NoDebuggerRequest, PleaseEnterDebugger, PleaseExitDebugger };
 
-    std::atomic<bool> m_mainLoopNeedsSlowStuff { false };
+    std::atomic<DWORD> m_pendingEvents { 0 };
     std::atomic<DebuggerRequest> m_debuggerRequest { NoDebuggerRequest };
     std::atomic<bool> m_shouldHardReboot { false };
 
+    static const unsigned long haltTimeoutMilliseconds = 10;
+    static const QWORD schedulerCheckInterval = 1024;
+    QWORD m_nextSchedulerCheckCycle { 0 };
+    QMutex m_haltMutex;
+    QWaitCondition m_haltCondition;
+    std::atomic<bool> m_isWaitingInHalt { false };
+
+    static const QWORD idlePollMaxCycles = 256;
+    static const unsigned idlePollThreshold = 64;
+    static const unsigned long idlePollTimeoutMilliseconds = 1;
+    struct IdlePoll {
+        WORD cs { 0 };
+        DWORD eip { 0 };
+        QWORD cycle { 0 };
+        QWORD memoryWriteCount { 0 };
+        DWORD registers[7] { };
+        unsigned count { 0 };
+    } m_idlePoll;
+    QWORD m_memoryWriteCount { 0 };
+
     QVector<WatchedAddress> m_watches;
 
 #ifdef SYMBOLIC_TRACING
@@ -1472,9 +1592,28 @@ private:
 
     QWORD m_cycle { 0 };
 
+    // Host memory that the decoder in decodeNext() is fetching the current instruction from.
+    // It's reset for every instruction, so it never outlives a change to CS or address translation.
+    static const DWORD maxInstructionLength = 15;
+    struct FetchWindow {
+        const BYTE* data { nullptr };
+        DWORD start { 0 };
+        QWORD end { 0 };
+    };
+    FetchWindow m_fetchWindow;
+    QElapsedTimer m_benchmarkTimer;
+
     mutable DWORD m_dirtyFlags { 0 };
     QWORD m_lastResult { 0 };
     unsigned m_lastOpSize { ByteSize };
+
+    // CF, OF and AF are derived from the last ADD/SUB-style operation when someone asks.
+    // These are kept apart from m_lastResult since logic ops only replace PF/ZF/SF.
+    QWORD m_lastArithmeticResult { 0 };
+    DWORD m_lastArithmeticDest { 0 };
+    DWORD m_lastArithmeticSrc { 0 };
+    unsigned m_lastArithmeticOpSize { ByteSize };
+    LazyOperation m_lastArithmeticOperation { LazyOperation::Add };
 };
 
 extern CPU* g_cpu;
@@ -1486,22 +1625,22 @@ ALWAYS_INLINE bool CPU::evaluate(BYTE conditionCode) const
     ASSERT(conditionCode <= 0xF);
 
     switch (conditionCode) {
-    case  0: return this->OF;                            // O
-    case  1: return !this->OF;                           // NO
-    case  2: return this->CF;                            // B, C, NAE
-    case  3: return !this->CF;                           // NB, NC, AE
+    case  0: return getOF();                             // O
+    case  1: return !getOF();                            // NO
+    case  2: return getCF();                             // B, C, NAE
+    case  3: return !getCF();                            // NB, NC, AE
     case  4: return getZF();                             // E, Z
     case  5: return !getZF();                            // NE, NZ
-    case  6: return (this->CF | getZF());                // BE, NA
-    case  7: return !(this->CF | getZF());               // NBE, A
+    case  6: return (getCF() | getZF());                 // BE, NA
+    case  7: return !(getCF() | getZF());                // NBE, A
     case  8: return getSF();                             // S
     case  9: return !getSF();                            // NS
     case 10: return getPF();                             // P, PE
     case 11: return !getPF();                            // NP, PO
-    case 12: return getSF() ^ this->OF;                  // L, NGE
-    case 13: return !(getSF() ^ this->OF);               // NL, GE
-    case 14: return (getSF() ^ this->OF) | getZF();      // LE, NG
-    case 15: return !((getSF() ^ this->OF) | getZF());   // NLE, G
+    case 12: return getSF() ^ getOF();                   // L, NGE
+    case 13: return !(getSF() ^ getOF());                // NL, GE
+    case 14: return (getSF() ^ getOF()) | getZF();       // LE, NG
+    case 15: return !((getSF() ^ getOF()) | getZF());    // NLE, G
     }
     return 0;
 }
@@ -1639,22 +1778,28 @@ inline void MemoryOrRegisterReference::write16(WORD data) { return write(data);
 inline void MemoryOrRegisterReference::write32(DWORD data) { ASSERT(m_cpu->o32()); return write(data); }
 
 template<typename T>
-void CPU::mathFlags(typename TypeDoubler<T>::type result, T dest, T src)
+ALWAYS_INLINE void CPU::setLazyFlags(LazyOperation operation, typename TypeDoubler<T>::type result, T dest, T src, DWORD flags)
 {
-    typedef typename TypeDoubler<T>::type DT;
-    m_dirtyFlags |= Flag::PF | Flag::ZF | Flag::SF;
+    m_dirtyFlags |= flags;
     m_lastResult = result;
     m_lastOpSize = TypeTrivia<T>::bits;
+    m_lastArithmeticResult = result;
+    m_lastArithmeticDest = dest;
+    m_lastArithmeticSrc = src;
+    m_lastArithmeticOpSize = TypeTrivia<T>::bits;
+    m_lastArithmeticOperation = operation;
+}
 
-    setCF(result & ((DT)TypeTrivia<T>::mask << TypeTrivia<T>::bits));
-    adjustFlag(result, dest, src);
+template<typename T>
+inline void CPU::mathFlags(typename TypeDoubler<T>::type result, T dest, T src)
+{
+    setLazyFlags<T>(LazyOperation::Add, result, dest, src, Flag::PF | Flag::ZF | Flag::SF | Flag::CF | Flag::OF | Flag::AF);
 }
 
 template<typename T>
 inline void CPU::cmpFlags(typename TypeDoubler<T>::type result, T dest, T src)
 {
-    mathFlags<T>(result, dest, src);
-    setOF((((result ^ dest) & (src ^ dest)) >> (TypeTrivia<T>::bits - 1)) & 1);
+    setLazyFlags<T>(LazyOperation::Sub, result, dest, src, Flag::PF | Flag::ZF | Flag::SF | Flag::CF | Flag::OF | Flag::AF);
 }
 
 ALWAYS_INLINE void Instruction::execute(CPU& cpu)
@@ -1665,5 +1810,9 @@ ALWAYS_INLINE void Instruction::execute(CPU& cpu)
     cpu.m_effectiveAddressSize32 = m_a32;
     if (m_hasRM)
         m_modrm.resolve(cpu);
+#ifdef CT_MEMBER_FUNCTION_DISPATCH
     (cpu.*m_impl)(*this);
+#else
+    m_impl(cpu, *this);
+#endif
 }
@@ -25,6 +25,7 @@
 #include "Descriptor.h"
 #include "CPU.h"
 #include "debugger.h"
+#include <QtCore/QDataStream>
 
 SegmentDescriptor CPU::getRealModeOrVM86Descriptor(WORD selector, SegmentRegisterIndex segmentRegister)
 {
@@ -98,8 +99,21 @@ Descriptor CPU::getDescriptor(DescriptorTableRegister& tableRegister, WORD index
         return ErrorDescriptor(Descriptor::LimitExceeded);
     }
 
-    DWORD hi = readMemoryMetal32(tableRegister.base().offset(tableIndex + 4));
-    DWORD lo = readMemoryMetal32(tableRegister.base().offset(tableIndex));
+    LinearAddress linearAddress = tableRegister.base().offset(tableIndex);
+    PhysicalAddress physicalAddress;
+    bool isCacheable = descriptorCacheAddress(linearAddress, physicalAddress);
+    if (isCacheable) {
+        if (auto* cached = m_descriptorCache.get(physicalAddress)) {
+            Descriptor cachedDescriptor = *cached;
+            cachedDescriptor.m_isGlobal = descriptor.m_isGlobal;
+            cachedDescriptor.m_RPL = descriptor.m_RPL;
+            cachedDescriptor.m_index = descriptor.m_index;
+            return cachedDescriptor;
+        }
+    }
+
+    DWORD hi = readMemoryMetal32(linearAddress.offset(4));
+    DWORD lo = readMemoryMetal32(linearAddress);
 
     descriptor.m_G = (hi >> 23) & 1; // Limit granularity, 0=1b, 1=4kB
     descriptor.m_D = (hi >> 22) & 1;
@@ -126,6 +140,9 @@ Descriptor CPU::getDescriptor(DescriptorTableRegister& tableRegister, WORD index
     descriptor.m_high = hi;
     descriptor.m_low = lo;
 
+    if (isCacheable)
+        m_descriptorCache.add(physicalAddress, descriptor);
+
     return descriptor;
 }
 
@@ -167,3 +184,20 @@ void CPU::writeToGDT(Descriptor& descriptor)
     writeMemoryMetal32(m_GDTR.base().offset(descriptor.index() + 4), descriptor.m_high);
     writeMemoryMetal32(m_GDTR.base().offset(descriptor.index()), descriptor.m_low);
 }
+
+void Descriptor::saveState(QDataStream& stream) const
+{
+    // The union is saved as the segment fields, which cover the gate fields as well.
+    stream << m_high << m_low << m_segmentBase << m_segmentLimit << m_DPL << m_type;
+    stream << m_G << m_D << m_P << m_AVL << m_DT << m_effectiveLimit;
+    stream << m_index << m_isGlobal << m_RPL << (quint8)m_error << m_loaded_in_ss;
+}
+
+void Descriptor::restoreState(QDataStream& stream)
+{
+    quint8 error;
+    stream >> m_high >> m_low >> m_segmentBase >> m_segmentLimit >> m_DPL >> m_type;
+    stream >> m_G >> m_D >> m_P >> m_AVL >> m_DT >> m_effectiveLimit;
+    stream >> m_index >> m_isGlobal >> m_RPL >> error >> m_loaded_in_ss;
+    m_error = static_cast<Error>(error);
+}
@@ -28,6 +28,8 @@
 #include "types.h"
 #include "Common.h"
 
+class QDataStream;
+
 class CodeSegmentDescriptor;
 class DataSegmentDescriptor;
 class Gate;
@@ -93,6 +95,10 @@ public:
     const CodeSegmentDescriptor& asCodeSegmentDescriptor() const;
     const DataSegmentDescriptor& asDataSegmentDescriptor() const;
 
+    // For saving cached descriptors, which may no longer match the tables they were loaded from.
+    void saveState(QDataStream&) const;
+    void restoreState(QDataStream&);
+
 protected:
     DWORD m_high { 0 };
     DWORD m_low { 0 };
@@ -117,6 +123,11 @@ protected:
 
     DWORD m_effectiveLimit { 0 };
 
+    // Precomputed by CPU::updateSegmentAccessCache() when a segment register is loaded.
+    // Each is a mask of (1 << MemoryAccessType); "unchecked" accesses also skip the limit check.
+    BYTE m_permittedAccess { 0 };
+    BYTE m_uncheckedAccess { 0 };
+
     // These are not part of the descriptor, but metadata about the lookup that found this descriptor.
     unsigned m_index { 0xFFFFFFFF };
     bool m_isGlobal { false };
@@ -246,6 +257,7 @@ public:
 
     DWORD effectiveLimit() const { return m_effectiveLimit; }
     bool granularity() const { return m_G; }
+    bool isFlat() const { return m_segmentBase == 0 && m_effectiveLimit == 0xffffffff; }
 
     LinearAddress linearAddress(DWORD offset) const { return LinearAddress(m_segmentBase + offset); }
 };
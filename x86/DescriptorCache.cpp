@@ -22,33 +22,52 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
-#include "ThreadedTimer.h"
-#include <QEventLoop>
 
-ThreadedTimer::ThreadedTimer(ThreadedTimer::Listener& listener, int ms)
-    : QThread(nullptr)
-    , m_listener(listener)
-    , m_ms(ms)
-{
-    start();
-}
+#include "DescriptorCache.h"
+#include "debug.h"
+
+//#define DEBUG_DESCRIPTOR_CACHE
 
-ThreadedTimer::~ThreadedTimer()
+void DescriptorCache::setPhysicalMemorySize(DWORD size)
 {
+    clear();
+    m_addressesOnPage.fill(QVector<DWORD>(), (size + pageSize - 1) / pageSize);
 }
 
-void ThreadedTimer::run()
+void DescriptorCache::add(PhysicalAddress address, const Descriptor& descriptor)
 {
-    QEventLoop eventLoop;
-    ThreadedTimerHelper helper(*this, m_ms);
-    eventLoop.exec();
+    DWORD pageIndex = address.get() / pageSize;
+    if (pageIndex >= (DWORD)m_addressesOnPage.size())
+        return;
+    if ((address.get() & (pageSize - 1)) > pageSize - 8)
+        return;
+
+    if (m_descriptors.size() >= maxEntries)
+        clear();
+
+    auto it = m_descriptors.find(address.get());
+    if (it != m_descriptors.end()) {
+        it.value() = descriptor;
+        return;
+    }
+    m_descriptors.insert(address.get(), descriptor);
+    m_addressesOnPage[pageIndex].append(address.get());
 }
 
-void ThreadedTimer::helperTimerFired()
+void DescriptorCache::invalidatePage(DWORD pageIndex)
 {
-    m_listener.threadedTimerFired(Badge<ThreadedTimer>());
+    auto& addresses = m_addressesOnPage[pageIndex];
+#ifdef DEBUG_DESCRIPTOR_CACHE
+    vlog(LogCPU, "Invalidating %d cached descriptor(s) on physical page %08x", addresses.size(), pageIndex * pageSize);
+#endif
+    for (DWORD address : addresses)
+        m_descriptors.remove(address);
+    addresses.clear();
 }
 
-ThreadedTimer::Listener::~Listener()
+void DescriptorCache::clear()
 {
+    m_descriptors.clear();
+    for (auto& addresses : m_addressesOnPage)
+        addresses.clear();
 }
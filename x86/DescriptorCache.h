@@ -22,48 +22,41 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
-#pragma once
 
-#include "types.h"
-#include <QThread>
+#pragma once
 
-class ThreadedTimerHelper;
+#include "Descriptor.h"
+#include <QtCore/QHash>
+#include <QtCore/QVector>
 
-class ThreadedTimer final : public QThread {
-    Q_OBJECT
+// Decoded GDT/LDT/IDT descriptors, indexed by the physical address of their first byte.
+//
+// Since entries are keyed on physical memory, reloading a table register or CR3 never makes
+// them stale; only writes to the memory they were decoded from do. The CPU keeps such writes
+// off the host pointer fast path (see hasDescriptorsOnPage()) and calls invalidatePage() for them.
+// Only descriptors that sit entirely within one page of plain RAM are cached.
+class DescriptorCache {
 public:
-    class Listener {
-    public:
-        virtual ~Listener();
-        virtual void threadedTimerFired(Badge<ThreadedTimer>) = 0;
-    };
+    static const DWORD pageSize = 4096;
+    static const int maxEntries = 16384;
 
-    explicit ThreadedTimer(Listener&, int ms);
-    virtual ~ThreadedTimer();
-
-private:
-    friend class ThreadedTimerHelper;
-    virtual void run() override;
-    void helperTimerFired();
-    Listener& m_listener;
-    int m_ms { 0 };
-};
+    void setPhysicalMemorySize(DWORD);
 
-class ThreadedTimerHelper : public QObject {
-    Q_OBJECT
-public:
-    explicit ThreadedTimerHelper(ThreadedTimer& threadedTimer, int ms)
-        : m_threadedTimer(threadedTimer)
+    const Descriptor* get(PhysicalAddress address) const
     {
-        startTimer(ms);
+        auto it = m_descriptors.constFind(address.get());
+        if (it == m_descriptors.constEnd())
+            return nullptr;
+        return &it.value();
     }
 
-    virtual void timerEvent(QTimerEvent*) override
-    {
-        m_threadedTimer.helperTimerFired();
-    }
+    void add(PhysicalAddress, const Descriptor&);
+
+    bool hasDescriptorsOnPage(DWORD pageIndex) const { return pageIndex < (DWORD)m_addressesOnPage.size() && !m_addressesOnPage[pageIndex].isEmpty(); }
+    void invalidatePage(DWORD pageIndex);
+    void clear();
 
 private:
-    ThreadedTimer& m_threadedTimer;
+    QHash<DWORD, Descriptor> m_descriptors;
+    QVector<QVector<DWORD>> m_addressesOnPage;
 };
-
@@ -0,0 +1,65 @@
+// Computron x86 PC Emulator
+// Copyright (C) 2003-2018 Andreas Kling <awesomekling@gmail.com>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY ANDREAS KLING ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANDREAS KLING OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "DirtyPageBitmap.h"
+#include <algorithm>
+
+void DirtyPageBitmap::setPhysicalMemorySize(DWORD size)
+{
+    m_pageCount = (size + pageSize - 1) / pageSize;
+    m_words = std::vector<std::atomic<QWORD>>((m_pageCount + bitsPerWord - 1) / bitsPerWord);
+    // Nothing has been recorded about fresh memory yet, so all of it counts as changed.
+    markAllDirty();
+}
+
+void DirtyPageBitmap::markAllDirty()
+{
+    for (DWORD i = 0; i < m_pageCount; ++i)
+        markDirty(i);
+}
+
+bool DirtyPageBitmap::isDirty(DWORD pageIndex) const
+{
+    if (pageIndex >= m_pageCount)
+        return false;
+    return m_words[pageIndex / bitsPerWord].load(std::memory_order_relaxed) & (1ull << (pageIndex % bitsPerWord));
+}
+
+QVector<DWORD> DirtyPageBitmap::takeDirtyPages(DWORD firstPage, DWORD pageCount)
+{
+    QVector<DWORD> pages;
+    DWORD endPage = std::min<QWORD>((QWORD)firstPage + pageCount, m_pageCount);
+    for (DWORD page = firstPage; page < endPage; ) {
+        DWORD wordIndex = page / bitsPerWord;
+        DWORD firstBit = page % bitsPerWord;
+        DWORD bitCount = std::min(bitsPerWord - firstBit, endPage - page);
+        QWORD mask = (bitCount == bitsPerWord ? ~0ull : ((1ull << bitCount) - 1)) << firstBit;
+        QWORD bits = m_words[wordIndex].fetch_and(~mask, std::memory_order_relaxed) & mask;
+        for (; bits; bits &= bits - 1)
+            pages.append(wordIndex * bitsPerWord + __builtin_ctzll(bits));
+        page += bitCount;
+    }
+    return pages;
+}
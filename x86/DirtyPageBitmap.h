@@ -0,0 +1,68 @@
+// Computron x86 PC Emulator
+// Copyright (C) 2003-2018 Andreas Kling <awesomekling@gmail.com>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY ANDREAS KLING ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANDREAS KLING OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#pragma once
+
+#include "types.h"
+#include <QtCore/QVector>
+#include <atomic>
+#include <vector>
+
+// One bit per 4 KB page of guest RAM, set whenever the page is written.
+//
+// The CPU marks pages from writePhysicalMemory() and from the host pointer fast paths, so every
+// store to RAM is accounted for. Consumers (snapshots, framebuffer updates, etc.) collect and
+// clear the pages that changed with takeDirtyPages(), which is safe to call from any thread.
+class DirtyPageBitmap {
+public:
+    static const DWORD pageSize = 4096;
+
+    void setPhysicalMemorySize(DWORD);
+    DWORD pageCount() const { return m_pageCount; }
+
+    void markDirty(DWORD pageIndex)
+    {
+        if (pageIndex >= m_pageCount)
+            return;
+        auto& word = m_words[pageIndex / bitsPerWord];
+        QWORD bit = 1ull << (pageIndex % bitsPerWord);
+        // Most writes hit pages that are already dirty, and a load is much cheaper than an atomic OR.
+        if (!(word.load(std::memory_order_relaxed) & bit))
+            word.fetch_or(bit, std::memory_order_relaxed);
+    }
+
+    void markAllDirty();
+    bool isDirty(DWORD pageIndex) const;
+
+    // Atomically clears the dirty bits for a range of pages, returning the pages that were set.
+    QVector<DWORD> takeDirtyPages(DWORD firstPage, DWORD pageCount);
+    QVector<DWORD> takeDirtyPages() { return takeDirtyPages(0, m_pageCount); }
+
+private:
+    static const DWORD bitsPerWord = 64;
+
+    std::vector<std::atomic<QWORD>> m_words;
+    DWORD m_pageCount { 0 };
+};
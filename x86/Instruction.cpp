@@ -158,6 +158,17 @@ struct InstructionDescriptor {
     IsLockPrefixAllowed lockPrefixAllowed { LockPrefixNotAllowed };
 };
 
+#ifdef CT_MEMBER_FUNCTION_DISPATCH
+#define IMPL(handler) &CPU::handler
+#else
+template<void (CPU::*handler)(Instruction&)>
+static void dispatch(CPU& cpu, Instruction& insn)
+{
+    (cpu.*handler)(insn);
+}
+#define IMPL(handler) &dispatch<&CPU::handler>
+#endif
+
 static InstructionDescriptor s_table16[256];
 static InstructionDescriptor s_table32[256];
 static InstructionDescriptor s_0F_table16[256];
@@ -318,61 +329,61 @@ static void buildSlash(InstructionDescriptor* table, BYTE op, BYTE slash, const
     build(d.slashes, slash, mnemonic, format, impl, lockPrefixAllowed);
 }
 
-static void build0F(BYTE op, const char* mnemonic, InstructionFormat format, void (CPU::*impl)(Instruction&), IsLockPrefixAllowed lockPrefixAllowed = LockPrefixNotAllowed)
+static void build0F(BYTE op, const char* mnemonic, InstructionFormat format, InstructionImpl impl, IsLockPrefixAllowed lockPrefixAllowed = LockPrefixNotAllowed)
 {
     build(s_0F_table16, op, mnemonic, format, impl, lockPrefixAllowed);
     build(s_0F_table32, op, mnemonic, format, impl, lockPrefixAllowed);
 }
 
-static void build(BYTE op, const char* mnemonic, InstructionFormat format, void (CPU::*impl)(Instruction&), IsLockPrefixAllowed lockPrefixAllowed = LockPrefixNotAllowed)
+static void build(BYTE op, const char* mnemonic, InstructionFormat format, InstructionImpl impl, IsLockPrefixAllowed lockPrefixAllowed = LockPrefixNotAllowed)
 {
     build(s_table16, op, mnemonic, format, impl, lockPrefixAllowed);
     build(s_table32, op, mnemonic, format, impl, lockPrefixAllowed);
 }
 
-static void build(BYTE op, const char* mnemonic, InstructionFormat format16, void (CPU::*impl16)(Instruction&), InstructionFormat format32, void (CPU::*impl32)(Instruction&), IsLockPrefixAllowed lockPrefixAllowed = LockPrefixNotAllowed)
+static void build(BYTE op, const char* mnemonic, InstructionFormat format16, InstructionImpl impl16, InstructionFormat format32, InstructionImpl impl32, IsLockPrefixAllowed lockPrefixAllowed = LockPrefixNotAllowed)
 {
     build(s_table16, op, mnemonic, format16, impl16, lockPrefixAllowed);
     build(s_table32, op, mnemonic, format32, impl32, lockPrefixAllowed);
 }
 
-static void build0F(BYTE op, const char* mnemonic, InstructionFormat format16, void (CPU::*impl16)(Instruction&), InstructionFormat format32, void (CPU::*impl32)(Instruction&), IsLockPrefixAllowed lockPrefixAllowed = LockPrefixNotAllowed)
+static void build0F(BYTE op, const char* mnemonic, InstructionFormat format16, InstructionImpl impl16, InstructionFormat format32, InstructionImpl impl32, IsLockPrefixAllowed lockPrefixAllowed = LockPrefixNotAllowed)
 {
     build(s_0F_table16, op, mnemonic, format16, impl16, lockPrefixAllowed);
     build(s_0F_table32, op, mnemonic, format32, impl32, lockPrefixAllowed);
 }
 
-static void build(BYTE op, const char* mnemonic16, InstructionFormat format16, void (CPU::*impl16)(Instruction&), const char* mnemonic32, InstructionFormat format32, void (CPU::*impl32)(Instruction&), IsLockPrefixAllowed lockPrefixAllowed = LockPrefixNotAllowed)
+static void build(BYTE op, const char* mnemonic16, InstructionFormat format16, InstructionImpl impl16, const char* mnemonic32, InstructionFormat format32, InstructionImpl impl32, IsLockPrefixAllowed lockPrefixAllowed = LockPrefixNotAllowed)
 {
     build(s_table16, op, mnemonic16, format16, impl16, lockPrefixAllowed);
     build(s_table32, op, mnemonic32, format32, impl32, lockPrefixAllowed);
 }
 
-static void build0F(BYTE op, const char* mnemonic16, InstructionFormat format16, void (CPU::*impl16)(Instruction&), const char* mnemonic32, InstructionFormat format32, void (CPU::*impl32)(Instruction&), IsLockPrefixAllowed lockPrefixAllowed = LockPrefixNotAllowed)
+static void build0F(BYTE op, const char* mnemonic16, InstructionFormat format16, InstructionImpl impl16, const char* mnemonic32, InstructionFormat format32, InstructionImpl impl32, IsLockPrefixAllowed lockPrefixAllowed = LockPrefixNotAllowed)
 {
     build(s_0F_table16, op, mnemonic16, format16, impl16, lockPrefixAllowed);
     build(s_0F_table32, op, mnemonic32, format32, impl32, lockPrefixAllowed);
 }
 
-static void buildSlash(BYTE op, BYTE slash, const char* mnemonic, InstructionFormat format, void (CPU::*impl)(Instruction&), IsLockPrefixAllowed lockPrefixAllowed = LockPrefixNotAllowed)
+static void buildSlash(BYTE op, BYTE slash, const char* mnemonic, InstructionFormat format, InstructionImpl impl, IsLockPrefixAllowed lockPrefixAllowed = LockPrefixNotAllowed)
 {
     buildSlash(s_table16, op, slash, mnemonic, format, impl, lockPrefixAllowed);
     buildSlash(s_table32, op, slash, mnemonic, format, impl, lockPrefixAllowed);
 }
 
-static void buildSlash(BYTE op, BYTE slash, const char* mnemonic, InstructionFormat format16, void (CPU::*impl16)(Instruction&), InstructionFormat format32, void (CPU::*impl32)(Instruction&), IsLockPrefixAllowed lockPrefixAllowed = LockPrefixNotAllowed)
+static void buildSlash(BYTE op, BYTE slash, const char* mnemonic, InstructionFormat format16, InstructionImpl impl16, InstructionFormat format32, InstructionImpl impl32, IsLockPrefixAllowed lockPrefixAllowed = LockPrefixNotAllowed)
 {
     buildSlash(s_table16, op, slash, mnemonic, format16, impl16, lockPrefixAllowed);
     buildSlash(s_table32, op, slash, mnemonic, format32, impl32, lockPrefixAllowed);
 }
 
-static void build0FSlash(BYTE op, BYTE slash, const char* mnemonic, InstructionFormat format16, void (CPU::*impl16)(Instruction&), InstructionFormat format32, void (CPU::*impl32)(Instruction&), IsLockPrefixAllowed lockPrefixAllowed = LockPrefixNotAllowed)
+static void build0FSlash(BYTE op, BYTE slash, const char* mnemonic, InstructionFormat format16, InstructionImpl impl16, InstructionFormat format32, InstructionImpl impl32, IsLockPrefixAllowed lockPrefixAllowed = LockPrefixNotAllowed)
 {
     buildSlash(s_0F_table16, op, slash, mnemonic, format16, impl16, lockPrefixAllowed);
     buildSlash(s_0F_table32, op, slash, mnemonic, format32, impl32, lockPrefixAllowed);
 }
 
-static void build0FSlash(BYTE op, BYTE slash, const char* mnemonic, InstructionFormat format, void (CPU::*impl)(Instruction&), IsLockPrefixAllowed lockPrefixAllowed = LockPrefixNotAllowed)
+static void build0FSlash(BYTE op, BYTE slash, const char* mnemonic, InstructionFormat format, InstructionImpl impl, IsLockPrefixAllowed lockPrefixAllowed = LockPrefixNotAllowed)
 {
     buildSlash(s_0F_table16, op, slash, mnemonic, format, impl, lockPrefixAllowed);
     buildSlash(s_0F_table32, op, slash, mnemonic, format, impl, lockPrefixAllowed);
@@ -384,420 +395,420 @@ void buildOpcodeTablesIfNeeded()
     if (hasBuiltTables)
         return;
 
-    build(0x00, "ADD",    OP_RM8_reg8,         &CPU::_ADD_RM8_reg8, LockPrefixAllowed);
-    build(0x01, "ADD",    OP_RM16_reg16,       &CPU::_ADD_RM16_reg16,  OP_RM32_reg32,  &CPU::_ADD_RM32_reg32, LockPrefixAllowed);
-    build(0x02, "ADD",    OP_reg8_RM8,         &CPU::_ADD_reg8_RM8, LockPrefixAllowed);
-    build(0x03, "ADD",    OP_reg16_RM16,       &CPU::_ADD_reg16_RM16,  OP_reg32_RM32,  &CPU::_ADD_reg32_RM32, LockPrefixAllowed);
-    build(0x04, "ADD",    OP_AL_imm8,          &CPU::_ADD_AL_imm8);
-    build(0x05, "ADD",    OP_AX_imm16,         &CPU::_ADD_AX_imm16,    OP_EAX_imm32,   &CPU::_ADD_EAX_imm32);
-    build(0x06, "PUSH",   OP_ES,               &CPU::_PUSH_ES);
-    build(0x07, "POP",    OP_ES,               &CPU::_POP_ES);
-    build(0x08, "OR",     OP_RM8_reg8,         &CPU::_OR_RM8_reg8, LockPrefixAllowed);
-    build(0x09, "OR",     OP_RM16_reg16,       &CPU::_OR_RM16_reg16,   OP_RM32_reg32,  &CPU::_OR_RM32_reg32, LockPrefixAllowed);
-    build(0x0A, "OR",     OP_reg8_RM8,         &CPU::_OR_reg8_RM8, LockPrefixAllowed);
-    build(0x0B, "OR",     OP_reg16_RM16,       &CPU::_OR_reg16_RM16,   OP_reg32_RM32,  &CPU::_OR_reg32_RM32, LockPrefixAllowed);
-    build(0x0C, "OR",     OP_AL_imm8,          &CPU::_OR_AL_imm8);
-    build(0x0D, "OR",     OP_AX_imm16,         &CPU::_OR_AX_imm16,     OP_EAX_imm32,   &CPU::_OR_EAX_imm32);
-    build(0x0E, "PUSH",   OP_CS,               &CPU::_PUSH_CS);
-
-    build(0x10, "ADC",    OP_RM8_reg8,         &CPU::_ADC_RM8_reg8, LockPrefixAllowed);
-    build(0x11, "ADC",    OP_RM16_reg16,       &CPU::_ADC_RM16_reg16,  OP_RM32_reg32,  &CPU::_ADC_RM32_reg32, LockPrefixAllowed);
-    build(0x12, "ADC",    OP_reg8_RM8,         &CPU::_ADC_reg8_RM8, LockPrefixAllowed);
-    build(0x13, "ADC",    OP_reg16_RM16,       &CPU::_ADC_reg16_RM16,  OP_reg32_RM32,  &CPU::_ADC_reg32_RM32, LockPrefixAllowed);
-    build(0x14, "ADC",    OP_AL_imm8,          &CPU::_ADC_AL_imm8);
-    build(0x15, "ADC",    OP_AX_imm16,         &CPU::_ADC_AX_imm16,    OP_EAX_imm32,   &CPU::_ADC_EAX_imm32);
-    build(0x16, "PUSH",   OP_SS,               &CPU::_PUSH_SS);
-    build(0x17, "POP",    OP_SS,               &CPU::_POP_SS);
-    build(0x18, "SBB",    OP_RM8_reg8,         &CPU::_SBB_RM8_reg8, LockPrefixAllowed);
-    build(0x19, "SBB",    OP_RM16_reg16,       &CPU::_SBB_RM16_reg16,  OP_RM32_reg32,  &CPU::_SBB_RM32_reg32, LockPrefixAllowed);
-    build(0x1A, "SBB",    OP_reg8_RM8,         &CPU::_SBB_reg8_RM8, LockPrefixAllowed);
-    build(0x1B, "SBB",    OP_reg16_RM16,       &CPU::_SBB_reg16_RM16,  OP_reg32_RM32,  &CPU::_SBB_reg32_RM32, LockPrefixAllowed);
-    build(0x1C, "SBB",    OP_AL_imm8,          &CPU::_SBB_AL_imm8);
-    build(0x1D, "SBB",    OP_AX_imm16,         &CPU::_SBB_AX_imm16,    OP_EAX_imm32,   &CPU::_SBB_EAX_imm32);
-    build(0x1E, "PUSH",   OP_DS,               &CPU::_PUSH_DS);
-    build(0x1F, "POP",    OP_DS,               &CPU::_POP_DS);
-
-    build(0x20, "AND",    OP_RM8_reg8,         &CPU::_AND_RM8_reg8, LockPrefixAllowed);
-    build(0x21, "AND",    OP_RM16_reg16,       &CPU::_AND_RM16_reg16,  OP_RM32_reg32,  &CPU::_AND_RM32_reg32, LockPrefixAllowed);
-    build(0x22, "AND",    OP_reg8_RM8,         &CPU::_AND_reg8_RM8, LockPrefixAllowed);
-    build(0x23, "AND",    OP_reg16_RM16,       &CPU::_AND_reg16_RM16,  OP_reg32_RM32,  &CPU::_AND_reg32_RM32, LockPrefixAllowed);
-    build(0x24, "AND",    OP_AL_imm8,          &CPU::_AND_AL_imm8);
-    build(0x25, "AND",    OP_AX_imm16,         &CPU::_AND_AX_imm16,    OP_EAX_imm32,   &CPU::_AND_EAX_imm32);
-    build(0x27, "DAA",    OP,                  &CPU::_DAA);
-    build(0x28, "SUB",    OP_RM8_reg8,         &CPU::_SUB_RM8_reg8, LockPrefixAllowed);
-    build(0x29, "SUB",    OP_RM16_reg16,       &CPU::_SUB_RM16_reg16,  OP_RM32_reg32,  &CPU::_SUB_RM32_reg32, LockPrefixAllowed);
-    build(0x2A, "SUB",    OP_reg8_RM8,         &CPU::_SUB_reg8_RM8, LockPrefixAllowed);
-    build(0x2B, "SUB",    OP_reg16_RM16,       &CPU::_SUB_reg16_RM16,  OP_reg32_RM32,  &CPU::_SUB_reg32_RM32, LockPrefixAllowed);
-    build(0x2C, "SUB",    OP_AL_imm8,          &CPU::_SUB_AL_imm8);
-    build(0x2D, "SUB",    OP_AX_imm16,         &CPU::_SUB_AX_imm16,    OP_EAX_imm32,   &CPU::_SUB_EAX_imm32);
-    build(0x2F, "DAS",    OP,                  &CPU::_DAS);
-
-    build(0x30, "XOR",    OP_RM8_reg8,         &CPU::_XOR_RM8_reg8, LockPrefixAllowed);
-    build(0x31, "XOR",    OP_RM16_reg16,       &CPU::_XOR_RM16_reg16,  OP_RM32_reg32,  &CPU::_XOR_RM32_reg32, LockPrefixAllowed);
-    build(0x32, "XOR",    OP_reg8_RM8,         &CPU::_XOR_reg8_RM8, LockPrefixAllowed);
-    build(0x33, "XOR",    OP_reg16_RM16,       &CPU::_XOR_reg16_RM16,  OP_reg32_RM32,  &CPU::_XOR_reg32_RM32, LockPrefixAllowed);
-    build(0x34, "XOR",    OP_AL_imm8,          &CPU::_XOR_AL_imm8);
-    build(0x35, "XOR",    OP_AX_imm16,         &CPU::_XOR_AX_imm16,    OP_EAX_imm32,   &CPU::_XOR_EAX_imm32);
-    build(0x37, "AAA",    OP,                  &CPU::_AAA);
-    build(0x38, "CMP",    OP_RM8_reg8,         &CPU::_CMP_RM8_reg8, LockPrefixAllowed);
-    build(0x39, "CMP",    OP_RM16_reg16,       &CPU::_CMP_RM16_reg16,  OP_RM32_reg32,  &CPU::_CMP_RM32_reg32, LockPrefixAllowed);
-    build(0x3A, "CMP",    OP_reg8_RM8,         &CPU::_CMP_reg8_RM8, LockPrefixAllowed);
-    build(0x3B, "CMP",    OP_reg16_RM16,       &CPU::_CMP_reg16_RM16,  OP_reg32_RM32,  &CPU::_CMP_reg32_RM32, LockPrefixAllowed);
-    build(0x3C, "CMP",    OP_AL_imm8,          &CPU::_CMP_AL_imm8);
-    build(0x3D, "CMP",    OP_AX_imm16,         &CPU::_CMP_AX_imm16,    OP_EAX_imm32,   &CPU::_CMP_EAX_imm32);
-    build(0x3F, "AAS",    OP,                  &CPU::_AAS);
+    build(0x00, "ADD",    OP_RM8_reg8,         IMPL(_ADD_RM8_reg8), LockPrefixAllowed);
+    build(0x01, "ADD",    OP_RM16_reg16,       IMPL(_ADD_RM16_reg16),  OP_RM32_reg32,  IMPL(_ADD_RM32_reg32), LockPrefixAllowed);
+    build(0x02, "ADD",    OP_reg8_RM8,         IMPL(_ADD_reg8_RM8), LockPrefixAllowed);
+    build(0x03, "ADD",    OP_reg16_RM16,       IMPL(_ADD_reg16_RM16),  OP_reg32_RM32,  IMPL(_ADD_reg32_RM32), LockPrefixAllowed);
+    build(0x04, "ADD",    OP_AL_imm8,          IMPL(_ADD_AL_imm8));
+    build(0x05, "ADD",    OP_AX_imm16,         IMPL(_ADD_AX_imm16),    OP_EAX_imm32,   IMPL(_ADD_EAX_imm32));
+    build(0x06, "PUSH",   OP_ES,               IMPL(_PUSH_ES));
+    build(0x07, "POP",    OP_ES,               IMPL(_POP_ES));
+    build(0x08, "OR",     OP_RM8_reg8,         IMPL(_OR_RM8_reg8), LockPrefixAllowed);
+    build(0x09, "OR",     OP_RM16_reg16,       IMPL(_OR_RM16_reg16),   OP_RM32_reg32,  IMPL(_OR_RM32_reg32), LockPrefixAllowed);
+    build(0x0A, "OR",     OP_reg8_RM8,         IMPL(_OR_reg8_RM8), LockPrefixAllowed);
+    build(0x0B, "OR",     OP_reg16_RM16,       IMPL(_OR_reg16_RM16),   OP_reg32_RM32,  IMPL(_OR_reg32_RM32), LockPrefixAllowed);
+    build(0x0C, "OR",     OP_AL_imm8,          IMPL(_OR_AL_imm8));
+    build(0x0D, "OR",     OP_AX_imm16,         IMPL(_OR_AX_imm16),     OP_EAX_imm32,   IMPL(_OR_EAX_imm32));
+    build(0x0E, "PUSH",   OP_CS,               IMPL(_PUSH_CS));
+
+    build(0x10, "ADC",    OP_RM8_reg8,         IMPL(_ADC_RM8_reg8), LockPrefixAllowed);
+    build(0x11, "ADC",    OP_RM16_reg16,       IMPL(_ADC_RM16_reg16),  OP_RM32_reg32,  IMPL(_ADC_RM32_reg32), LockPrefixAllowed);
+    build(0x12, "ADC",    OP_reg8_RM8,         IMPL(_ADC_reg8_RM8), LockPrefixAllowed);
+    build(0x13, "ADC",    OP_reg16_RM16,       IMPL(_ADC_reg16_RM16),  OP_reg32_RM32,  IMPL(_ADC_reg32_RM32), LockPrefixAllowed);
+    build(0x14, "ADC",    OP_AL_imm8,          IMPL(_ADC_AL_imm8));
+    build(0x15, "ADC",    OP_AX_imm16,         IMPL(_ADC_AX_imm16),    OP_EAX_imm32,   IMPL(_ADC_EAX_imm32));
+    build(0x16, "PUSH",   OP_SS,               IMPL(_PUSH_SS));
+    build(0x17, "POP",    OP_SS,               IMPL(_POP_SS));
+    build(0x18, "SBB",    OP_RM8_reg8,         IMPL(_SBB_RM8_reg8), LockPrefixAllowed);
+    build(0x19, "SBB",    OP_RM16_reg16,       IMPL(_SBB_RM16_reg16),  OP_RM32_reg32,  IMPL(_SBB_RM32_reg32), LockPrefixAllowed);
+    build(0x1A, "SBB",    OP_reg8_RM8,         IMPL(_SBB_reg8_RM8), LockPrefixAllowed);
+    build(0x1B, "SBB",    OP_reg16_RM16,       IMPL(_SBB_reg16_RM16),  OP_reg32_RM32,  IMPL(_SBB_reg32_RM32), LockPrefixAllowed);
+    build(0x1C, "SBB",    OP_AL_imm8,          IMPL(_SBB_AL_imm8));
+    build(0x1D, "SBB",    OP_AX_imm16,         IMPL(_SBB_AX_imm16),    OP_EAX_imm32,   IMPL(_SBB_EAX_imm32));
+    build(0x1E, "PUSH",   OP_DS,               IMPL(_PUSH_DS));
+    build(0x1F, "POP",    OP_DS,               IMPL(_POP_DS));
+
+    build(0x20, "AND",    OP_RM8_reg8,         IMPL(_AND_RM8_reg8), LockPrefixAllowed);
+    build(0x21, "AND",    OP_RM16_reg16,       IMPL(_AND_RM16_reg16),  OP_RM32_reg32,  IMPL(_AND_RM32_reg32), LockPrefixAllowed);
+    build(0x22, "AND",    OP_reg8_RM8,         IMPL(_AND_reg8_RM8), LockPrefixAllowed);
+    build(0x23, "AND",    OP_reg16_RM16,       IMPL(_AND_reg16_RM16),  OP_reg32_RM32,  IMPL(_AND_reg32_RM32), LockPrefixAllowed);
+    build(0x24, "AND",    OP_AL_imm8,          IMPL(_AND_AL_imm8));
+    build(0x25, "AND",    OP_AX_imm16,         IMPL(_AND_AX_imm16),    OP_EAX_imm32,   IMPL(_AND_EAX_imm32));
+    build(0x27, "DAA",    OP,                  IMPL(_DAA));
+    build(0x28, "SUB",    OP_RM8_reg8,         IMPL(_SUB_RM8_reg8), LockPrefixAllowed);
+    build(0x29, "SUB",    OP_RM16_reg16,       IMPL(_SUB_RM16_reg16),  OP_RM32_reg32,  IMPL(_SUB_RM32_reg32), LockPrefixAllowed);
+    build(0x2A, "SUB",    OP_reg8_RM8,         IMPL(_SUB_reg8_RM8), LockPrefixAllowed);
+    build(0x2B, "SUB",    OP_reg16_RM16,       IMPL(_SUB_reg16_RM16),  OP_reg32_RM32,  IMPL(_SUB_reg32_RM32), LockPrefixAllowed);
+    build(0x2C, "SUB",    OP_AL_imm8,          IMPL(_SUB_AL_imm8));
+    build(0x2D, "SUB",    OP_AX_imm16,         IMPL(_SUB_AX_imm16),    OP_EAX_imm32,   IMPL(_SUB_EAX_imm32));
+    build(0x2F, "DAS",    OP,                  IMPL(_DAS));
+
+    build(0x30, "XOR",    OP_RM8_reg8,         IMPL(_XOR_RM8_reg8), LockPrefixAllowed);
+    build(0x31, "XOR",    OP_RM16_reg16,       IMPL(_XOR_RM16_reg16),  OP_RM32_reg32,  IMPL(_XOR_RM32_reg32), LockPrefixAllowed);
+    build(0x32, "XOR",    OP_reg8_RM8,         IMPL(_XOR_reg8_RM8), LockPrefixAllowed);
+    build(0x33, "XOR",    OP_reg16_RM16,       IMPL(_XOR_reg16_RM16),  OP_reg32_RM32,  IMPL(_XOR_reg32_RM32), LockPrefixAllowed);
+    build(0x34, "XOR",    OP_AL_imm8,          IMPL(_XOR_AL_imm8));
+    build(0x35, "XOR",    OP_AX_imm16,         IMPL(_XOR_AX_imm16),    OP_EAX_imm32,   IMPL(_XOR_EAX_imm32));
+    build(0x37, "AAA",    OP,                  IMPL(_AAA));
+    build(0x38, "CMP",    OP_RM8_reg8,         IMPL(_CMP_RM8_reg8), LockPrefixAllowed);
+    build(0x39, "CMP",    OP_RM16_reg16,       IMPL(_CMP_RM16_reg16),  OP_RM32_reg32,  IMPL(_CMP_RM32_reg32), LockPrefixAllowed);
+    build(0x3A, "CMP",    OP_reg8_RM8,         IMPL(_CMP_reg8_RM8), LockPrefixAllowed);
+    build(0x3B, "CMP",    OP_reg16_RM16,       IMPL(_CMP_reg16_RM16),  OP_reg32_RM32,  IMPL(_CMP_reg32_RM32), LockPrefixAllowed);
+    build(0x3C, "CMP",    OP_AL_imm8,          IMPL(_CMP_AL_imm8));
+    build(0x3D, "CMP",    OP_AX_imm16,         IMPL(_CMP_AX_imm16),    OP_EAX_imm32,   IMPL(_CMP_EAX_imm32));
+    build(0x3F, "AAS",    OP,                  IMPL(_AAS));
 
     for (BYTE i = 0; i <= 7; ++i)
-        build(0x40 + i, "INC", OP_reg16, &CPU::_INC_reg16, OP_reg32, &CPU::_INC_reg32);
+        build(0x40 + i, "INC", OP_reg16, IMPL(_INC_reg16), OP_reg32, IMPL(_INC_reg32));
 
     for (BYTE i = 0; i <= 7; ++i)
-        build(0x48 + i, "DEC", OP_reg16, &CPU::_DEC_reg16, OP_reg32, &CPU::_DEC_reg32);
+        build(0x48 + i, "DEC", OP_reg16, IMPL(_DEC_reg16), OP_reg32, IMPL(_DEC_reg32));
 
     for (BYTE i = 0; i <= 7; ++i)
-        build(0x50 + i, "PUSH", OP_reg16, &CPU::_PUSH_reg16, OP_reg32, &CPU::_PUSH_reg32);
+        build(0x50 + i, "PUSH", OP_reg16, IMPL(_PUSH_reg16), OP_reg32, IMPL(_PUSH_reg32));
 
     for (BYTE i = 0; i <= 7; ++i)
-        build(0x58 + i, "POP", OP_reg16, &CPU::_POP_reg16, OP_reg32, &CPU::_POP_reg32);
-
-    build(0x60, "PUSHAW", OP,                  &CPU::_PUSHA, "PUSHAD", OP,             &CPU::_PUSHAD);
-    build(0x61, "POPAW",  OP,                  &CPU::_POPA,  "POPAD",  OP,             &CPU::_POPAD);
-    build(0x62, "BOUND",  OP_reg16_RM16,       &CPU::_BOUND, "BOUND",  OP_reg32_RM32,  &CPU::_BOUND);
-    build(0x63, "ARPL",   OP_RM16_reg16,       &CPU::_ARPL);
-
-    build(0x68, "PUSH",   OP_imm16,            &CPU::_PUSH_imm16,      OP_imm32,       &CPU::_PUSH_imm32);
-    build(0x69, "IMUL",   OP_reg16_RM16_imm16, &CPU::_IMUL_reg16_RM16_imm16, OP_reg32_RM32_imm32, &CPU::_IMUL_reg32_RM32_imm32);
-    build(0x6A, "PUSH",   OP_imm8,             &CPU::_PUSH_imm8);
-    build(0x6B, "IMUL",   OP_reg16_RM16_imm8,  &CPU::_IMUL_reg16_RM16_imm8, OP_reg32_RM32_imm8, &CPU::_IMUL_reg32_RM32_imm8);
-    build(0x6C, "INSB",   OP,                  &CPU::_INSB);
-    build(0x6D, "INSW",   OP,                  &CPU::_INSW,  "INSD",   OP,             &CPU::_INSD);
-    build(0x6E, "OUTSB",  OP,                  &CPU::_OUTSB);
-    build(0x6F, "OUTSW",  OP,                  &CPU::_OUTSW, "OUTSD",  OP,             &CPU::_OUTSD);
-
-    build(0x70, "JO",     OP_short_imm8,       &CPU::_Jcc_imm8);
-    build(0x71, "JNO",    OP_short_imm8,       &CPU::_Jcc_imm8);
-    build(0x72, "JC",     OP_short_imm8,       &CPU::_Jcc_imm8);
-    build(0x73, "JNC",    OP_short_imm8,       &CPU::_Jcc_imm8);
-    build(0x74, "JZ",     OP_short_imm8,       &CPU::_Jcc_imm8);
-    build(0x75, "JNZ",    OP_short_imm8,       &CPU::_Jcc_imm8);
-    build(0x76, "JNA",    OP_short_imm8,       &CPU::_Jcc_imm8);
-    build(0x77, "JA",     OP_short_imm8,       &CPU::_Jcc_imm8);
-    build(0x78, "JS",     OP_short_imm8,       &CPU::_Jcc_imm8);
-    build(0x79, "JNS",    OP_short_imm8,       &CPU::_Jcc_imm8);
-    build(0x7A, "JP",     OP_short_imm8,       &CPU::_Jcc_imm8);
-    build(0x7B, "JNP",    OP_short_imm8,       &CPU::_Jcc_imm8);
-    build(0x7C, "JL",     OP_short_imm8,       &CPU::_Jcc_imm8);
-    build(0x7D, "JNL",    OP_short_imm8,       &CPU::_Jcc_imm8);
-    build(0x7E, "JNG",    OP_short_imm8,       &CPU::_Jcc_imm8);
-    build(0x7F, "JG",     OP_short_imm8,       &CPU::_Jcc_imm8);
-
-    build(0x84, "TEST",   OP_RM8_reg8,         &CPU::_TEST_RM8_reg8);
-    build(0x85, "TEST",   OP_RM16_reg16,       &CPU::_TEST_RM16_reg16, OP_RM32_reg32,  &CPU::_TEST_RM32_reg32);
-    build(0x86, "XCHG",   OP_reg8_RM8,         &CPU::_XCHG_reg8_RM8, LockPrefixAllowed);
-    build(0x87, "XCHG",   OP_reg16_RM16,       &CPU::_XCHG_reg16_RM16, OP_reg32_RM32,  &CPU::_XCHG_reg32_RM32, LockPrefixAllowed);
-    build(0x88, "MOV",    OP_RM8_reg8,         &CPU::_MOV_RM8_reg8);
-    build(0x89, "MOV",    OP_RM16_reg16,       &CPU::_MOV_RM16_reg16,  OP_RM32_reg32,  &CPU::_MOV_RM32_reg32);
-    build(0x8A, "MOV",    OP_reg8_RM8,         &CPU::_MOV_reg8_RM8);
-    build(0x8B, "MOV",    OP_reg16_RM16,       &CPU::_MOV_reg16_RM16,  OP_reg32_RM32,  &CPU::_MOV_reg32_RM32);
-    build(0x8C, "MOV",    OP_RM16_seg,         &CPU::_MOV_RM16_seg);
-    build(0x8D, "LEA",    OP_reg16_mem16,      &CPU::_LEA_reg16_mem16, OP_reg32_mem32, &CPU::_LEA_reg32_mem32);
-    build(0x8E, "MOV",    OP_seg_RM16,         &CPU::_MOV_seg_RM16,    OP_seg_RM32,    &CPU::_MOV_seg_RM32);
-
-    build(0x90, "NOP", OP, &CPU::_NOP);
+        build(0x58 + i, "POP", OP_reg16, IMPL(_POP_reg16), OP_reg32, IMPL(_POP_reg32));
+
+    build(0x60, "PUSHAW", OP,                  IMPL(_PUSHA), "PUSHAD", OP,             IMPL(_PUSHAD));
+    build(0x61, "POPAW",  OP,                  IMPL(_POPA),  "POPAD",  OP,             IMPL(_POPAD));
+    build(0x62, "BOUND",  OP_reg16_RM16,       IMPL(_BOUND), "BOUND",  OP_reg32_RM32,  IMPL(_BOUND));
+    build(0x63, "ARPL",   OP_RM16_reg16,       IMPL(_ARPL));
+
+    build(0x68, "PUSH",   OP_imm16,            IMPL(_PUSH_imm16),      OP_imm32,       IMPL(_PUSH_imm32));
+    build(0x69, "IMUL",   OP_reg16_RM16_imm16, IMPL(_IMUL_reg16_RM16_imm16), OP_reg32_RM32_imm32, IMPL(_IMUL_reg32_RM32_imm32));
+    build(0x6A, "PUSH",   OP_imm8,             IMPL(_PUSH_imm8));
+    build(0x6B, "IMUL",   OP_reg16_RM16_imm8,  IMPL(_IMUL_reg16_RM16_imm8), OP_reg32_RM32_imm8, IMPL(_IMUL_reg32_RM32_imm8));
+    build(0x6C, "INSB",   OP,                  IMPL(_INSB));
+    build(0x6D, "INSW",   OP,                  IMPL(_INSW),  "INSD",   OP,             IMPL(_INSD));
+    build(0x6E, "OUTSB",  OP,                  IMPL(_OUTSB));
+    build(0x6F, "OUTSW",  OP,                  IMPL(_OUTSW), "OUTSD",  OP,             IMPL(_OUTSD));
+
+    build(0x70, "JO",     OP_short_imm8,       IMPL(_Jcc_imm8));
+    build(0x71, "JNO",    OP_short_imm8,       IMPL(_Jcc_imm8));
+    build(0x72, "JC",     OP_short_imm8,       IMPL(_Jcc_imm8));
+    build(0x73, "JNC",    OP_short_imm8,       IMPL(_Jcc_imm8));
+    build(0x74, "JZ",     OP_short_imm8,       IMPL(_Jcc_imm8));
+    build(0x75, "JNZ",    OP_short_imm8,       IMPL(_Jcc_imm8));
+    build(0x76, "JNA",    OP_short_imm8,       IMPL(_Jcc_imm8));
+    build(0x77, "JA",     OP_short_imm8,       IMPL(_Jcc_imm8));
+    build(0x78, "JS",     OP_short_imm8,       IMPL(_Jcc_imm8));
+    build(0x79, "JNS",    OP_short_imm8,       IMPL(_Jcc_imm8));
+    build(0x7A, "JP",     OP_short_imm8,       IMPL(_Jcc_imm8));
+    build(0x7B, "JNP",    OP_short_imm8,       IMPL(_Jcc_imm8));
+    build(0x7C, "JL",     OP_short_imm8,       IMPL(_Jcc_imm8));
+    build(0x7D, "JNL",    OP_short_imm8,       IMPL(_Jcc_imm8));
+    build(0x7E, "JNG",    OP_short_imm8,       IMPL(_Jcc_imm8));
+    build(0x7F, "JG",     OP_short_imm8,       IMPL(_Jcc_imm8));
+
+    build(0x84, "TEST",   OP_RM8_reg8,         IMPL(_TEST_RM8_reg8));
+    build(0x85, "TEST",   OP_RM16_reg16,       IMPL(_TEST_RM16_reg16), OP_RM32_reg32,  IMPL(_TEST_RM32_reg32));
+    build(0x86, "XCHG",   OP_reg8_RM8,         IMPL(_XCHG_reg8_RM8), LockPrefixAllowed);
+    build(0x87, "XCHG",   OP_reg16_RM16,       IMPL(_XCHG_reg16_RM16), OP_reg32_RM32,  IMPL(_XCHG_reg32_RM32), LockPrefixAllowed);
+    build(0x88, "MOV",    OP_RM8_reg8,         IMPL(_MOV_RM8_reg8));
+    build(0x89, "MOV",    OP_RM16_reg16,       IMPL(_MOV_RM16_reg16),  OP_RM32_reg32,  IMPL(_MOV_RM32_reg32));
+    build(0x8A, "MOV",    OP_reg8_RM8,         IMPL(_MOV_reg8_RM8));
+    build(0x8B, "MOV",    OP_reg16_RM16,       IMPL(_MOV_reg16_RM16),  OP_reg32_RM32,  IMPL(_MOV_reg32_RM32));
+    build(0x8C, "MOV",    OP_RM16_seg,         IMPL(_MOV_RM16_seg));
+    build(0x8D, "LEA",    OP_reg16_mem16,      IMPL(_LEA_reg16_mem16), OP_reg32_mem32, IMPL(_LEA_reg32_mem32));
+    build(0x8E, "MOV",    OP_seg_RM16,         IMPL(_MOV_seg_RM16),    OP_seg_RM32,    IMPL(_MOV_seg_RM32));
+
+    build(0x90, "NOP", OP, IMPL(_NOP));
 
     for (BYTE i = 0; i <= 6; ++i)
-        build(0x91 + i, "XCHG", OP_AX_reg16, &CPU::_XCHG_AX_reg16, OP_EAX_reg32, &CPU::_XCHG_EAX_reg32);
-
-    build(0x98, "CBW",    OP,                  &CPU::_CBW,      "CWDE", OP,             &CPU::_CWDE);
-    build(0x99, "CWD",    OP,                  &CPU::_CWD,       "CDQ", OP,             &CPU::_CDQ);
-    build(0x9A, "CALL",   OP_imm16_imm16,      &CPU::_CALL_imm16_imm16, OP_imm16_imm32, &CPU::_CALL_imm16_imm32);
-    build(0x9B, "WAIT",   OP,                  &CPU::_WAIT);
-    build(0x9C, "PUSHFW", OP,                  &CPU::_PUSHF,  "PUSHFD", OP,             &CPU::_PUSHFD);
-    build(0x9D, "POPFW",  OP,                  &CPU::_POPF,    "POPFD", OP,             &CPU::_POPFD);
-    build(0x9E, "SAHF",   OP,                  &CPU::_SAHF);
-    build(0x9F, "LAHF",   OP,                  &CPU::_LAHF);
-
-    build(0xA0, "MOV",    OP_AL_moff8,         &CPU::_MOV_AL_moff8);
-    build(0xA1, "MOV",    OP_AX_moff16,        &CPU::_MOV_AX_moff16,    OP_EAX_moff32,  &CPU::_MOV_EAX_moff32);
-    build(0xA2, "MOV",    OP_moff8_AL,         &CPU::_MOV_moff8_AL);
-    build(0xA3, "MOV",    OP_moff16_AX,        &CPU::_MOV_moff16_AX,    OP_moff32_EAX,  &CPU::_MOV_moff32_EAX);
-    build(0xA4, "MOVSB",  OP,                  &CPU::_MOVSB);
-    build(0xA5, "MOVSW",  OP,                  &CPU::_MOVSW,   "MOVSD", OP,             &CPU::_MOVSD);
-    build(0xA6, "CMPSB",  OP,                  &CPU::_CMPSB);
-    build(0xA7, "CMPSW",  OP,                  &CPU::_CMPSW,   "CMPSD", OP,             &CPU::_CMPSD);
-    build(0xA8, "TEST",   OP_AL_imm8,          &CPU::_TEST_AL_imm8);
-    build(0xA9, "TEST",   OP_AX_imm16,         &CPU::_TEST_AX_imm16,    OP_EAX_imm32,   &CPU::_TEST_EAX_imm32);
-    build(0xAA, "STOSB",  OP,                  &CPU::_STOSB);
-    build(0xAB, "STOSW",  OP,                  &CPU::_STOSW,   "STOSD", OP,             &CPU::_STOSD);
-    build(0xAC, "LODSB",  OP,                  &CPU::_LODSB);
-    build(0xAD, "LODSW",  OP,                  &CPU::_LODSW,   "LODSD", OP,             &CPU::_LODSD);
-    build(0xAE, "SCASB",  OP,                  &CPU::_SCASB);
-    build(0xAF, "SCASW",  OP,                  &CPU::_SCASW,   "SCASD", OP,             &CPU::_SCASD);
+        build(0x91 + i, "XCHG", OP_AX_reg16, IMPL(_XCHG_AX_reg16), OP_EAX_reg32, IMPL(_XCHG_EAX_reg32));
+
+    build(0x98, "CBW",    OP,                  IMPL(_CBW),      "CWDE", OP,             IMPL(_CWDE));
+    build(0x99, "CWD",    OP,                  IMPL(_CWD),       "CDQ", OP,             IMPL(_CDQ));
+    build(0x9A, "CALL",   OP_imm16_imm16,      IMPL(_CALL_imm16_imm16), OP_imm16_imm32, IMPL(_CALL_imm16_imm32));
+    build(0x9B, "WAIT",   OP,                  IMPL(_WAIT));
+    build(0x9C, "PUSHFW", OP,                  IMPL(_PUSHF),  "PUSHFD", OP,             IMPL(_PUSHFD));
+    build(0x9D, "POPFW",  OP,                  IMPL(_POPF),    "POPFD", OP,             IMPL(_POPFD));
+    build(0x9E, "SAHF",   OP,                  IMPL(_SAHF));
+    build(0x9F, "LAHF",   OP,                  IMPL(_LAHF));
+
+    build(0xA0, "MOV",    OP_AL_moff8,         IMPL(_MOV_AL_moff8));
+    build(0xA1, "MOV",    OP_AX_moff16,        IMPL(_MOV_AX_moff16),    OP_EAX_moff32,  IMPL(_MOV_EAX_moff32));
+    build(0xA2, "MOV",    OP_moff8_AL,         IMPL(_MOV_moff8_AL));
+    build(0xA3, "MOV",    OP_moff16_AX,        IMPL(_MOV_moff16_AX),    OP_moff32_EAX,  IMPL(_MOV_moff32_EAX));
+    build(0xA4, "MOVSB",  OP,                  IMPL(_MOVSB));
+    build(0xA5, "MOVSW",  OP,                  IMPL(_MOVSW),   "MOVSD", OP,             IMPL(_MOVSD));
+    build(0xA6, "CMPSB",  OP,                  IMPL(_CMPSB));
+    build(0xA7, "CMPSW",  OP,                  IMPL(_CMPSW),   "CMPSD", OP,             IMPL(_CMPSD));
+    build(0xA8, "TEST",   OP_AL_imm8,          IMPL(_TEST_AL_imm8));
+    build(0xA9, "TEST",   OP_AX_imm16,         IMPL(_TEST_AX_imm16),    OP_EAX_imm32,   IMPL(_TEST_EAX_imm32));
+    build(0xAA, "STOSB",  OP,                  IMPL(_STOSB));
+    build(0xAB, "STOSW",  OP,                  IMPL(_STOSW),   "STOSD", OP,             IMPL(_STOSD));
+    build(0xAC, "LODSB",  OP,                  IMPL(_LODSB));
+    build(0xAD, "LODSW",  OP,                  IMPL(_LODSW),   "LODSD", OP,             IMPL(_LODSD));
+    build(0xAE, "SCASB",  OP,                  IMPL(_SCASB));
+    build(0xAF, "SCASW",  OP,                  IMPL(_SCASW),   "SCASD", OP,             IMPL(_SCASD));
 
     for (BYTE i = 0xb0; i <= 0xb7; ++i)
-        build(i, "MOV", OP_reg8_imm8, &CPU::_MOV_reg8_imm8);
+        build(i, "MOV", OP_reg8_imm8, IMPL(_MOV_reg8_imm8));
 
     for (BYTE i = 0xb8; i <= 0xbf; ++i)
-        build(i, "MOV", OP_reg16_imm16, &CPU::_MOV_reg16_imm16, OP_reg32_imm32, &CPU::_MOV_reg32_imm32);
-
-    build(0xC2, "RET",    OP_imm16,            &CPU::_RET_imm16);
-    build(0xC3, "RET",    OP,                  &CPU::_RET);
-    build(0xC4, "LES",    OP_reg16_mem16,      &CPU::_LES_reg16_mem16,  OP_reg32_mem32, &CPU::_LES_reg32_mem32);
-    build(0xC5, "LDS",    OP_reg16_mem16,      &CPU::_LDS_reg16_mem16,  OP_reg32_mem32, &CPU::_LDS_reg32_mem32);
-    build(0xC6, "MOV",    OP_RM8_imm8,         &CPU::_MOV_RM8_imm8);
-    build(0xC7, "MOV",    OP_RM16_imm16,       &CPU::_MOV_RM16_imm16,   OP_RM32_imm32,  &CPU::_MOV_RM32_imm32);
-    build(0xC8, "ENTER",  OP_imm8_imm16,       &CPU::_ENTER16,          OP_imm8_imm16,  &CPU::_ENTER32);
-    build(0xC9, "LEAVE",  OP,                  &CPU::_LEAVE16,          OP,             &CPU::_LEAVE32);
-    build(0xCA, "RETF",   OP_imm16,            &CPU::_RETF_imm16);
-    build(0xCB, "RETF",   OP,                  &CPU::_RETF);
-    build(0xCC, "INT3",   OP_3 ,               &CPU::_INT3);
-    build(0xCD, "INT",    OP_imm8,             &CPU::_INT_imm8);
-    build(0xCE, "INTO",   OP,                  &CPU::_INTO);
-    build(0xCF, "IRET",   OP,                  &CPU::_IRET);
-
-    build(0xD4, "AAM",    OP_imm8,             &CPU::_AAM);
-    build(0xD5, "AAD",    OP_imm8,             &CPU::_AAD);
-    build(0xD6, "SALC",   OP,                  &CPU::_SALC);
-    build(0xD7, "XLAT",   OP,                  &CPU::_XLAT);
+        build(i, "MOV", OP_reg16_imm16, IMPL(_MOV_reg16_imm16), OP_reg32_imm32, IMPL(_MOV_reg32_imm32));
+
+    build(0xC2, "RET",    OP_imm16,            IMPL(_RET_imm16));
+    build(0xC3, "RET",    OP,                  IMPL(_RET));
+    build(0xC4, "LES",    OP_reg16_mem16,      IMPL(_LES_reg16_mem16),  OP_reg32_mem32, IMPL(_LES_reg32_mem32));
+    build(0xC5, "LDS",    OP_reg16_mem16,      IMPL(_LDS_reg16_mem16),  OP_reg32_mem32, IMPL(_LDS_reg32_mem32));
+    build(0xC6, "MOV",    OP_RM8_imm8,         IMPL(_MOV_RM8_imm8));
+    build(0xC7, "MOV",    OP_RM16_imm16,       IMPL(_MOV_RM16_imm16),   OP_RM32_imm32,  IMPL(_MOV_RM32_imm32));
+    build(0xC8, "ENTER",  OP_imm8_imm16,       IMPL(_ENTER16),          OP_imm8_imm16,  IMPL(_ENTER32));
+    build(0xC9, "LEAVE",  OP,                  IMPL(_LEAVE16),          OP,             IMPL(_LEAVE32));
+    build(0xCA, "RETF",   OP_imm16,            IMPL(_RETF_imm16));
+    build(0xCB, "RETF",   OP,                  IMPL(_RETF));
+    build(0xCC, "INT3",   OP_3 ,               IMPL(_INT3));
+    build(0xCD, "INT",    OP_imm8,             IMPL(_INT_imm8));
+    build(0xCE, "INTO",   OP,                  IMPL(_INTO));
+    build(0xCF, "IRET",   OP,                  IMPL(_IRET));
+
+    build(0xD4, "AAM",    OP_imm8,             IMPL(_AAM));
+    build(0xD5, "AAD",    OP_imm8,             IMPL(_AAD));
+    build(0xD6, "SALC",   OP,                  IMPL(_SALC));
+    build(0xD7, "XLAT",   OP,                  IMPL(_XLAT));
 
     // FIXME: D8-DF == FPU
     for (BYTE i = 0; i <= 7; ++i)
-        build(0xD8 + i, "FPU?",   OP_RM8,              &CPU::_ESCAPE);
-
-    build(0xE0, "LOOPNZ", OP_imm8,             &CPU::_LOOPNZ_imm8);
-    build(0xE1, "LOOPZ",  OP_imm8,             &CPU::_LOOPZ_imm8);
-    build(0xE2, "LOOP",   OP_imm8,             &CPU::_LOOP_imm8);
-    build(0xE3, "JCXZ",   OP_imm8,             &CPU::_JCXZ_imm8);
-    build(0xE4, "IN",     OP_AL_imm8,          &CPU::_IN_AL_imm8);
-    build(0xE5, "IN",     OP_AX_imm8,          &CPU::_IN_AX_imm8,       OP_EAX_imm8,    &CPU::_IN_EAX_imm8);
-    build(0xE6, "OUT",    OP_imm8_AL,          &CPU::_OUT_imm8_AL);
-    build(0xE7, "OUT",    OP_imm8_AX,          &CPU::_OUT_imm8_AX,      OP_imm8_EAX,    &CPU::_OUT_imm8_EAX);
-    build(0xE8, "CALL",   OP_relimm16,         &CPU::_CALL_imm16,       OP_relimm32,    &CPU::_CALL_imm32);
-    build(0xE9, "JMP",    OP_relimm16,         &CPU::_JMP_imm16,        OP_relimm32,    &CPU::_JMP_imm32);
-    build(0xEA, "JMP",    OP_imm16_imm16,      &CPU::_JMP_imm16_imm16,  OP_imm16_imm32, &CPU::_JMP_imm16_imm32);
-    build(0xEB, "JMP",    OP_short_imm8,       &CPU::_JMP_short_imm8);
-    build(0xEC, "IN",     OP_AL_DX,            &CPU::_IN_AL_DX);
-    build(0xED, "IN",     OP_AX_DX,            &CPU::_IN_AX_DX,         OP_EAX_DX,      &CPU::_IN_EAX_DX);
-    build(0xEE, "OUT",    OP_DX_AL,            &CPU::_OUT_DX_AL);
-    build(0xEF, "OUT",    OP_DX_AX,            &CPU::_OUT_DX_AX,        OP_DX_EAX,      &CPU::_OUT_DX_EAX);
-
-    build(0xF1, "VKILL",  OP,                  &CPU::_VKILL);
-
-    build(0xF4, "HLT",    OP,                  &CPU::_HLT);
-    build(0xF5, "CMC",    OP,                  &CPU::_CMC);
-
-    build(0xF8, "CLC",    OP,                  &CPU::_CLC);
-    build(0xF9, "STC",    OP,                  &CPU::_STC);
-    build(0xFA, "CLI",    OP,                  &CPU::_CLI);
-    build(0xFB, "STI",    OP,                  &CPU::_STI);
-    build(0xFC, "CLD",    OP,                  &CPU::_CLD);
-    build(0xFD, "STD",    OP,                  &CPU::_STD);
-
-    buildSlash(0x80, 0, "ADD",   OP_RM8_imm8,   &CPU::_ADD_RM8_imm8, LockPrefixAllowed);
-    buildSlash(0x80, 1, "OR",    OP_RM8_imm8,   &CPU::_OR_RM8_imm8, LockPrefixAllowed);
-    buildSlash(0x80, 2, "ADC",   OP_RM8_imm8,   &CPU::_ADC_RM8_imm8, LockPrefixAllowed);
-    buildSlash(0x80, 3, "SBB",   OP_RM8_imm8,   &CPU::_SBB_RM8_imm8, LockPrefixAllowed);
-    buildSlash(0x80, 4, "AND",   OP_RM8_imm8,   &CPU::_AND_RM8_imm8, LockPrefixAllowed);
-    buildSlash(0x80, 5, "SUB",   OP_RM8_imm8,   &CPU::_SUB_RM8_imm8, LockPrefixAllowed);
-    buildSlash(0x80, 6, "XOR",   OP_RM8_imm8,   &CPU::_XOR_RM8_imm8, LockPrefixAllowed);
-    buildSlash(0x80, 7, "CMP",   OP_RM8_imm8,   &CPU::_CMP_RM8_imm8);
-
-    buildSlash(0x81, 0, "ADD",   OP_RM16_imm16, &CPU::_ADD_RM16_imm16,  OP_RM32_imm32, &CPU::_ADD_RM32_imm32, LockPrefixAllowed);
-    buildSlash(0x81, 1, "OR",    OP_RM16_imm16, &CPU::_OR_RM16_imm16,   OP_RM32_imm32, &CPU::_OR_RM32_imm32, LockPrefixAllowed);
-    buildSlash(0x81, 2, "ADC",   OP_RM16_imm16, &CPU::_ADC_RM16_imm16,  OP_RM32_imm32, &CPU::_ADC_RM32_imm32, LockPrefixAllowed);
-    buildSlash(0x81, 3, "SBB",   OP_RM16_imm16, &CPU::_SBB_RM16_imm16,  OP_RM32_imm32, &CPU::_SBB_RM32_imm32, LockPrefixAllowed);
-    buildSlash(0x81, 4, "AND",   OP_RM16_imm16, &CPU::_AND_RM16_imm16,  OP_RM32_imm32, &CPU::_AND_RM32_imm32, LockPrefixAllowed);
-    buildSlash(0x81, 5, "SUB",   OP_RM16_imm16, &CPU::_SUB_RM16_imm16,  OP_RM32_imm32, &CPU::_SUB_RM32_imm32, LockPrefixAllowed);
-    buildSlash(0x81, 6, "XOR",   OP_RM16_imm16, &CPU::_XOR_RM16_imm16,  OP_RM32_imm32, &CPU::_XOR_RM32_imm32, LockPrefixAllowed);
-    buildSlash(0x81, 7, "CMP",   OP_RM16_imm16, &CPU::_CMP_RM16_imm16,  OP_RM32_imm32, &CPU::_CMP_RM32_imm32);
-
-    buildSlash(0x83, 0, "ADD",   OP_RM16_imm8,  &CPU::_ADD_RM16_imm8,   OP_RM32_imm8,  &CPU::_ADD_RM32_imm8, LockPrefixAllowed);
-    buildSlash(0x83, 1, "OR",    OP_RM16_imm8,  &CPU::_OR_RM16_imm8,    OP_RM32_imm8,  &CPU::_OR_RM32_imm8, LockPrefixAllowed);
-    buildSlash(0x83, 2, "ADC",   OP_RM16_imm8,  &CPU::_ADC_RM16_imm8,   OP_RM32_imm8,  &CPU::_ADC_RM32_imm8, LockPrefixAllowed);
-    buildSlash(0x83, 3, "SBB",   OP_RM16_imm8,  &CPU::_SBB_RM16_imm8,   OP_RM32_imm8,  &CPU::_SBB_RM32_imm8, LockPrefixAllowed);
-    buildSlash(0x83, 4, "AND",   OP_RM16_imm8,  &CPU::_AND_RM16_imm8,   OP_RM32_imm8,  &CPU::_AND_RM32_imm8, LockPrefixAllowed);
-    buildSlash(0x83, 5, "SUB",   OP_RM16_imm8,  &CPU::_SUB_RM16_imm8,   OP_RM32_imm8,  &CPU::_SUB_RM32_imm8, LockPrefixAllowed);
-    buildSlash(0x83, 6, "XOR",   OP_RM16_imm8,  &CPU::_XOR_RM16_imm8,   OP_RM32_imm8,  &CPU::_XOR_RM32_imm8, LockPrefixAllowed);
-    buildSlash(0x83, 7, "CMP",   OP_RM16_imm8,  &CPU::_CMP_RM16_imm8,   OP_RM32_imm8,  &CPU::_CMP_RM32_imm8);
-
-    buildSlash(0x8F, 0, "POP",   OP_RM16,       &CPU::_POP_RM16,        OP_RM32,       &CPU::_POP_RM32);
-
-    buildSlash(0xC0, 0, "ROL",   OP_RM8_imm8,   &CPU::_ROL_RM8_imm8);
-    buildSlash(0xC0, 1, "ROR",   OP_RM8_imm8,   &CPU::_ROR_RM8_imm8);
-    buildSlash(0xC0, 2, "RCL",   OP_RM8_imm8,   &CPU::_RCL_RM8_imm8);
-    buildSlash(0xC0, 3, "RCR",   OP_RM8_imm8,   &CPU::_RCR_RM8_imm8);
-    buildSlash(0xC0, 4, "SHL",   OP_RM8_imm8,   &CPU::_SHL_RM8_imm8);
-    buildSlash(0xC0, 5, "SHR",   OP_RM8_imm8,   &CPU::_SHR_RM8_imm8);
-    buildSlash(0xC0, 6, "SHL",   OP_RM8_imm8,   &CPU::_SHL_RM8_imm8); // Undocumented
-    buildSlash(0xC0, 7, "SAR",   OP_RM8_imm8,   &CPU::_SAR_RM8_imm8);
-
-    buildSlash(0xC1, 0, "ROL",   OP_RM16_imm8,  &CPU::_ROL_RM16_imm8,   OP_RM32_imm8,  &CPU::_ROL_RM32_imm8);
-    buildSlash(0xC1, 1, "ROR",   OP_RM16_imm8,  &CPU::_ROR_RM16_imm8,   OP_RM32_imm8,  &CPU::_ROR_RM32_imm8);
-    buildSlash(0xC1, 2, "RCL",   OP_RM16_imm8,  &CPU::_RCL_RM16_imm8,   OP_RM32_imm8,  &CPU::_RCL_RM32_imm8);
-    buildSlash(0xC1, 3, "RCR",   OP_RM16_imm8,  &CPU::_RCR_RM16_imm8,   OP_RM32_imm8,  &CPU::_RCR_RM32_imm8);
-    buildSlash(0xC1, 4, "SHL",   OP_RM16_imm8,  &CPU::_SHL_RM16_imm8,   OP_RM32_imm8,  &CPU::_SHL_RM32_imm8);
-    buildSlash(0xC1, 5, "SHR",   OP_RM16_imm8,  &CPU::_SHR_RM16_imm8,   OP_RM32_imm8,  &CPU::_SHR_RM32_imm8);
-    buildSlash(0xC1, 6, "SHL",   OP_RM16_imm8,  &CPU::_SHL_RM16_imm8,   OP_RM32_imm8,  &CPU::_SHL_RM32_imm8); // Undocumented
-    buildSlash(0xC1, 7, "SAR",   OP_RM16_imm8,  &CPU::_SAR_RM16_imm8,   OP_RM32_imm8,  &CPU::_SAR_RM32_imm8);
-
-    buildSlash(0xD0, 0, "ROL",   OP_RM8_1,      &CPU::_ROL_RM8_1);
-    buildSlash(0xD0, 1, "ROR",   OP_RM8_1,      &CPU::_ROR_RM8_1);
-    buildSlash(0xD0, 2, "RCL",   OP_RM8_1,      &CPU::_RCL_RM8_1);
-    buildSlash(0xD0, 3, "RCR",   OP_RM8_1,      &CPU::_RCR_RM8_1);
-    buildSlash(0xD0, 4, "SHL",   OP_RM8_1,      &CPU::_SHL_RM8_1);
-    buildSlash(0xD0, 5, "SHR",   OP_RM8_1,      &CPU::_SHR_RM8_1);
-    buildSlash(0xD0, 6, "SHL",   OP_RM8_1,      &CPU::_SHL_RM8_1); // Undocumented
-    buildSlash(0xD0, 7, "SAR",   OP_RM8_1,      &CPU::_SAR_RM8_1);
-
-    buildSlash(0xD1, 0, "ROL",   OP_RM16_1,     &CPU::_ROL_RM16_1,      OP_RM32_1,     &CPU::_ROL_RM32_1);
-    buildSlash(0xD1, 1, "ROR",   OP_RM16_1,     &CPU::_ROR_RM16_1,      OP_RM32_1,     &CPU::_ROR_RM32_1);
-    buildSlash(0xD1, 2, "RCL",   OP_RM16_1,     &CPU::_RCL_RM16_1,      OP_RM32_1,     &CPU::_RCL_RM32_1);
-    buildSlash(0xD1, 3, "RCR",   OP_RM16_1,     &CPU::_RCR_RM16_1,      OP_RM32_1,     &CPU::_RCR_RM32_1);
-    buildSlash(0xD1, 4, "SHL",   OP_RM16_1,     &CPU::_SHL_RM16_1,      OP_RM32_1,     &CPU::_SHL_RM32_1);
-    buildSlash(0xD1, 5, "SHR",   OP_RM16_1,     &CPU::_SHR_RM16_1,      OP_RM32_1,     &CPU::_SHR_RM32_1);
-    buildSlash(0xD1, 6, "SHL",   OP_RM16_1,     &CPU::_SHL_RM16_1,      OP_RM32_1,     &CPU::_SHL_RM32_1); // Undocumented
-    buildSlash(0xD1, 7, "SAR",   OP_RM16_1,     &CPU::_SAR_RM16_1,      OP_RM32_1,     &CPU::_SAR_RM32_1);
-
-    buildSlash(0xD2, 0, "ROL",   OP_RM8_CL,     &CPU::_ROL_RM8_CL);
-    buildSlash(0xD2, 1, "ROR",   OP_RM8_CL,     &CPU::_ROR_RM8_CL);
-    buildSlash(0xD2, 2, "RCL",   OP_RM8_CL,     &CPU::_RCL_RM8_CL);
-    buildSlash(0xD2, 3, "RCR",   OP_RM8_CL,     &CPU::_RCR_RM8_CL);
-    buildSlash(0xD2, 4, "SHL",   OP_RM8_CL,     &CPU::_SHL_RM8_CL);
-    buildSlash(0xD2, 5, "SHR",   OP_RM8_CL,     &CPU::_SHR_RM8_CL);
-    buildSlash(0xD2, 6, "SHL",   OP_RM8_CL,     &CPU::_SHL_RM8_CL); // Undocumented
-    buildSlash(0xD2, 7, "SAR",   OP_RM8_CL,     &CPU::_SAR_RM8_CL);
-
-    buildSlash(0xD3, 0, "ROL",   OP_RM16_CL,    &CPU::_ROL_RM16_CL,     OP_RM32_CL,    &CPU::_ROL_RM32_CL);
-    buildSlash(0xD3, 1, "ROR",   OP_RM16_CL,    &CPU::_ROR_RM16_CL,     OP_RM32_CL,    &CPU::_ROR_RM32_CL);
-    buildSlash(0xD3, 2, "RCL",   OP_RM16_CL,    &CPU::_RCL_RM16_CL,     OP_RM32_CL,    &CPU::_RCL_RM32_CL);
-    buildSlash(0xD3, 3, "RCR",   OP_RM16_CL,    &CPU::_RCR_RM16_CL,     OP_RM32_CL,    &CPU::_RCR_RM32_CL);
-    buildSlash(0xD3, 4, "SHL",   OP_RM16_CL,    &CPU::_SHL_RM16_CL,     OP_RM32_CL,    &CPU::_SHL_RM32_CL);
-    buildSlash(0xD3, 5, "SHR",   OP_RM16_CL,    &CPU::_SHR_RM16_CL,     OP_RM32_CL,    &CPU::_SHR_RM32_CL);
-    buildSlash(0xD3, 6, "SHL",   OP_RM16_CL,    &CPU::_SHL_RM16_CL,     OP_RM32_CL,    &CPU::_SHL_RM32_CL); // Undocumented
-    buildSlash(0xD3, 7, "SAR",   OP_RM16_CL,    &CPU::_SAR_RM16_CL,     OP_RM32_CL,    &CPU::_SAR_RM32_CL);
-
-    buildSlash(0xF6, 0, "TEST",  OP_RM8_imm8,   &CPU::_TEST_RM8_imm8);
-    buildSlash(0xF6, 1, "TEST",  OP_RM8_imm8,   &CPU::_TEST_RM8_imm8); // Undocumented
-    buildSlash(0xF6, 2, "NOT",   OP_RM8,        &CPU::_NOT_RM8, LockPrefixAllowed);
-    buildSlash(0xF6, 3, "NEG",   OP_RM8,        &CPU::_NEG_RM8, LockPrefixAllowed);
-    buildSlash(0xF6, 4, "MUL",   OP_RM8,        &CPU::_MUL_RM8);
-    buildSlash(0xF6, 5, "IMUL",  OP_RM8,        &CPU::_IMUL_RM8);
-    buildSlash(0xF6, 6, "DIV",   OP_RM8,        &CPU::_DIV_RM8);
-    buildSlash(0xF6, 7, "IDIV",  OP_RM8,        &CPU::_IDIV_RM8);
-
-    buildSlash(0xF7, 0, "TEST",  OP_RM16_imm16, &CPU::_TEST_RM16_imm16, OP_RM32_imm32, &CPU::_TEST_RM32_imm32);
-    buildSlash(0xF7, 1, "TEST",  OP_RM16_imm16, &CPU::_TEST_RM16_imm16, OP_RM32_imm32, &CPU::_TEST_RM32_imm32); // Undocumented
-    buildSlash(0xF7, 2, "NOT",   OP_RM16,       &CPU::_NOT_RM16,        OP_RM32,       &CPU::_NOT_RM32, LockPrefixAllowed);
-    buildSlash(0xF7, 3, "NEG",   OP_RM16,       &CPU::_NEG_RM16,        OP_RM32,       &CPU::_NEG_RM32, LockPrefixAllowed);
-    buildSlash(0xF7, 4, "MUL",   OP_RM16,       &CPU::_MUL_RM16,        OP_RM32,       &CPU::_MUL_RM32);
-    buildSlash(0xF7, 5, "IMUL",  OP_RM16,       &CPU::_IMUL_RM16,       OP_RM32,       &CPU::_IMUL_RM32);
-    buildSlash(0xF7, 6, "DIV",   OP_RM16,       &CPU::_DIV_RM16,        OP_RM32,       &CPU::_DIV_RM32);
-    buildSlash(0xF7, 7, "IDIV",  OP_RM16,       &CPU::_IDIV_RM16,       OP_RM32,       &CPU::_IDIV_RM32);
-
-    buildSlash(0xFE, 0, "INC",   OP_RM8,        &CPU::_INC_RM8, LockPrefixAllowed);
-    buildSlash(0xFE, 1, "DEC",   OP_RM8,        &CPU::_DEC_RM8, LockPrefixAllowed);
-
-    buildSlash(0xFF, 0, "INC",   OP_RM16,       &CPU::_INC_RM16,       OP_RM32,       &CPU::_INC_RM32, LockPrefixAllowed);
-    buildSlash(0xFF, 1, "DEC",   OP_RM16,       &CPU::_DEC_RM16,       OP_RM32,       &CPU::_DEC_RM32, LockPrefixAllowed);
-    buildSlash(0xFF, 2, "CALL",  OP_RM16,       &CPU::_CALL_RM16,      OP_RM32,       &CPU::_CALL_RM32);
-    buildSlash(0xFF, 3, "CALL",  OP_FAR_mem16,  &CPU::_CALL_FAR_mem16, OP_FAR_mem32,  &CPU::_CALL_FAR_mem32);
-    buildSlash(0xFF, 4, "JMP",   OP_RM16,       &CPU::_JMP_RM16,       OP_RM32,       &CPU::_JMP_RM32);
-    buildSlash(0xFF, 5, "JMP",   OP_FAR_mem16,  &CPU::_JMP_FAR_mem16,  OP_FAR_mem32,  &CPU::_JMP_FAR_mem32);
-    buildSlash(0xFF, 6, "PUSH",  OP_RM16,       &CPU::_PUSH_RM16,      OP_RM32,       &CPU::_PUSH_RM32);
+        build(0xD8 + i, "FPU?",   OP_RM8,              IMPL(_ESCAPE));
+
+    build(0xE0, "LOOPNZ", OP_imm8,             IMPL(_LOOPNZ_imm8));
+    build(0xE1, "LOOPZ",  OP_imm8,             IMPL(_LOOPZ_imm8));
+    build(0xE2, "LOOP",   OP_imm8,             IMPL(_LOOP_imm8));
+    build(0xE3, "JCXZ",   OP_imm8,             IMPL(_JCXZ_imm8));
+    build(0xE4, "IN",     OP_AL_imm8,          IMPL(_IN_AL_imm8));
+    build(0xE5, "IN",     OP_AX_imm8,          IMPL(_IN_AX_imm8),       OP_EAX_imm8,    IMPL(_IN_EAX_imm8));
+    build(0xE6, "OUT",    OP_imm8_AL,          IMPL(_OUT_imm8_AL));
+    build(0xE7, "OUT",    OP_imm8_AX,          IMPL(_OUT_imm8_AX),      OP_imm8_EAX,    IMPL(_OUT_imm8_EAX));
+    build(0xE8, "CALL",   OP_relimm16,         IMPL(_CALL_imm16),       OP_relimm32,    IMPL(_CALL_imm32));
+    build(0xE9, "JMP",    OP_relimm16,         IMPL(_JMP_imm16),        OP_relimm32,    IMPL(_JMP_imm32));
+    build(0xEA, "JMP",    OP_imm16_imm16,      IMPL(_JMP_imm16_imm16),  OP_imm16_imm32, IMPL(_JMP_imm16_imm32));
+    build(0xEB, "JMP",    OP_short_imm8,       IMPL(_JMP_short_imm8));
+    build(0xEC, "IN",     OP_AL_DX,            IMPL(_IN_AL_DX));
+    build(0xED, "IN",     OP_AX_DX,            IMPL(_IN_AX_DX),         OP_EAX_DX,      IMPL(_IN_EAX_DX));
+    build(0xEE, "OUT",    OP_DX_AL,            IMPL(_OUT_DX_AL));
+    build(0xEF, "OUT",    OP_DX_AX,            IMPL(_OUT_DX_AX),        OP_DX_EAX,      IMPL(_OUT_DX_EAX));
+
+    build(0xF1, "VKILL",  OP,                  IMPL(_VKILL));
+
+    build(0xF4, "HLT",    OP,                  IMPL(_HLT));
+    build(0xF5, "CMC",    OP,                  IMPL(_CMC));
+
+    build(0xF8, "CLC",    OP,                  IMPL(_CLC));
+    build(0xF9, "STC",    OP,                  IMPL(_STC));
+    build(0xFA, "CLI",    OP,                  IMPL(_CLI));
+    build(0xFB, "STI",    OP,                  IMPL(_STI));
+    build(0xFC, "CLD",    OP,                  IMPL(_CLD));
+    build(0xFD, "STD",    OP,                  IMPL(_STD));
+
+    buildSlash(0x80, 0, "ADD",   OP_RM8_imm8,   IMPL(_ADD_RM8_imm8), LockPrefixAllowed);
+    buildSlash(0x80, 1, "OR",    OP_RM8_imm8,   IMPL(_OR_RM8_imm8), LockPrefixAllowed);
+    buildSlash(0x80, 2, "ADC",   OP_RM8_imm8,   IMPL(_ADC_RM8_imm8), LockPrefixAllowed);
+    buildSlash(0x80, 3, "SBB",   OP_RM8_imm8,   IMPL(_SBB_RM8_imm8), LockPrefixAllowed);
+    buildSlash(0x80, 4, "AND",   OP_RM8_imm8,   IMPL(_AND_RM8_imm8), LockPrefixAllowed);
+    buildSlash(0x80, 5, "SUB",   OP_RM8_imm8,   IMPL(_SUB_RM8_imm8), LockPrefixAllowed);
+    buildSlash(0x80, 6, "XOR",   OP_RM8_imm8,   IMPL(_XOR_RM8_imm8), LockPrefixAllowed);
+    buildSlash(0x80, 7, "CMP",   OP_RM8_imm8,   IMPL(_CMP_RM8_imm8));
+
+    buildSlash(0x81, 0, "ADD",   OP_RM16_imm16, IMPL(_ADD_RM16_imm16),  OP_RM32_imm32, IMPL(_ADD_RM32_imm32), LockPrefixAllowed);
+    buildSlash(0x81, 1, "OR",    OP_RM16_imm16, IMPL(_OR_RM16_imm16),   OP_RM32_imm32, IMPL(_OR_RM32_imm32), LockPrefixAllowed);
+    buildSlash(0x81, 2, "ADC",   OP_RM16_imm16, IMPL(_ADC_RM16_imm16),  OP_RM32_imm32, IMPL(_ADC_RM32_imm32), LockPrefixAllowed);
+    buildSlash(0x81, 3, "SBB",   OP_RM16_imm16, IMPL(_SBB_RM16_imm16),  OP_RM32_imm32, IMPL(_SBB_RM32_imm32), LockPrefixAllowed);
+    buildSlash(0x81, 4, "AND",   OP_RM16_imm16, IMPL(_AND_RM16_imm16),  OP_RM32_imm32, IMPL(_AND_RM32_imm32), LockPrefixAllowed);
+    buildSlash(0x81, 5, "SUB",   OP_RM16_imm16, IMPL(_SUB_RM16_imm16),  OP_RM32_imm32, IMPL(_SUB_RM32_imm32), LockPrefixAllowed);
+    buildSlash(0x81, 6, "XOR",   OP_RM16_imm16, IMPL(_XOR_RM16_imm16),  OP_RM32_imm32, IMPL(_XOR_RM32_imm32), LockPrefixAllowed);
+    buildSlash(0x81, 7, "CMP",   OP_RM16_imm16, IMPL(_CMP_RM16_imm16),  OP_RM32_imm32, IMPL(_CMP_RM32_imm32));
+
+    buildSlash(0x83, 0, "ADD",   OP_RM16_imm8,  IMPL(_ADD_RM16_imm8),   OP_RM32_imm8,  IMPL(_ADD_RM32_imm8), LockPrefixAllowed);
+    buildSlash(0x83, 1, "OR",    OP_RM16_imm8,  IMPL(_OR_RM16_imm8),    OP_RM32_imm8,  IMPL(_OR_RM32_imm8), LockPrefixAllowed);
+    buildSlash(0x83, 2, "ADC",   OP_RM16_imm8,  IMPL(_ADC_RM16_imm8),   OP_RM32_imm8,  IMPL(_ADC_RM32_imm8), LockPrefixAllowed);
+    buildSlash(0x83, 3, "SBB",   OP_RM16_imm8,  IMPL(_SBB_RM16_imm8),   OP_RM32_imm8,  IMPL(_SBB_RM32_imm8), LockPrefixAllowed);
+    buildSlash(0x83, 4, "AND",   OP_RM16_imm8,  IMPL(_AND_RM16_imm8),   OP_RM32_imm8,  IMPL(_AND_RM32_imm8), LockPrefixAllowed);
+    buildSlash(0x83, 5, "SUB",   OP_RM16_imm8,  IMPL(_SUB_RM16_imm8),   OP_RM32_imm8,  IMPL(_SUB_RM32_imm8), LockPrefixAllowed);
+    buildSlash(0x83, 6, "XOR",   OP_RM16_imm8,  IMPL(_XOR_RM16_imm8),   OP_RM32_imm8,  IMPL(_XOR_RM32_imm8), LockPrefixAllowed);
+    buildSlash(0x83, 7, "CMP",   OP_RM16_imm8,  IMPL(_CMP_RM16_imm8),   OP_RM32_imm8,  IMPL(_CMP_RM32_imm8));
+
+    buildSlash(0x8F, 0, "POP",   OP_RM16,       IMPL(_POP_RM16),        OP_RM32,       IMPL(_POP_RM32));
+
+    buildSlash(0xC0, 0, "ROL",   OP_RM8_imm8,   IMPL(_ROL_RM8_imm8));
+    buildSlash(0xC0, 1, "ROR",   OP_RM8_imm8,   IMPL(_ROR_RM8_imm8));
+    buildSlash(0xC0, 2, "RCL",   OP_RM8_imm8,   IMPL(_RCL_RM8_imm8));
+    buildSlash(0xC0, 3, "RCR",   OP_RM8_imm8,   IMPL(_RCR_RM8_imm8));
+    buildSlash(0xC0, 4, "SHL",   OP_RM8_imm8,   IMPL(_SHL_RM8_imm8));
+    buildSlash(0xC0, 5, "SHR",   OP_RM8_imm8,   IMPL(_SHR_RM8_imm8));
+    buildSlash(0xC0, 6, "SHL",   OP_RM8_imm8,   IMPL(_SHL_RM8_imm8)); // Undocumented
+    buildSlash(0xC0, 7, "SAR",   OP_RM8_imm8,   IMPL(_SAR_RM8_imm8));
+
+    buildSlash(0xC1, 0, "ROL",   OP_RM16_imm8,  IMPL(_ROL_RM16_imm8),   OP_RM32_imm8,  IMPL(_ROL_RM32_imm8));
+    buildSlash(0xC1, 1, "ROR",   OP_RM16_imm8,  IMPL(_ROR_RM16_imm8),   OP_RM32_imm8,  IMPL(_ROR_RM32_imm8));
+    buildSlash(0xC1, 2, "RCL",   OP_RM16_imm8,  IMPL(_RCL_RM16_imm8),   OP_RM32_imm8,  IMPL(_RCL_RM32_imm8));
+    buildSlash(0xC1, 3, "RCR",   OP_RM16_imm8,  IMPL(_RCR_RM16_imm8),   OP_RM32_imm8,  IMPL(_RCR_RM32_imm8));
+    buildSlash(0xC1, 4, "SHL",   OP_RM16_imm8,  IMPL(_SHL_RM16_imm8),   OP_RM32_imm8,  IMPL(_SHL_RM32_imm8));
+    buildSlash(0xC1, 5, "SHR",   OP_RM16_imm8,  IMPL(_SHR_RM16_imm8),   OP_RM32_imm8,  IMPL(_SHR_RM32_imm8));
+    buildSlash(0xC1, 6, "SHL",   OP_RM16_imm8,  IMPL(_SHL_RM16_imm8),   OP_RM32_imm8,  IMPL(_SHL_RM32_imm8)); // Undocumented
+    buildSlash(0xC1, 7, "SAR",   OP_RM16_imm8,  IMPL(_SAR_RM16_imm8),   OP_RM32_imm8,  IMPL(_SAR_RM32_imm8));
+
+    buildSlash(0xD0, 0, "ROL",   OP_RM8_1,      IMPL(_ROL_RM8_1));
+    buildSlash(0xD0, 1, "ROR",   OP_RM8_1,      IMPL(_ROR_RM8_1));
+    buildSlash(0xD0, 2, "RCL",   OP_RM8_1,      IMPL(_RCL_RM8_1));
+    buildSlash(0xD0, 3, "RCR",   OP_RM8_1,      IMPL(_RCR_RM8_1));
+    buildSlash(0xD0, 4, "SHL",   OP_RM8_1,      IMPL(_SHL_RM8_1));
+    buildSlash(0xD0, 5, "SHR",   OP_RM8_1,      IMPL(_SHR_RM8_1));
+    buildSlash(0xD0, 6, "SHL",   OP_RM8_1,      IMPL(_SHL_RM8_1)); // Undocumented
+    buildSlash(0xD0, 7, "SAR",   OP_RM8_1,      IMPL(_SAR_RM8_1));
+
+    buildSlash(0xD1, 0, "ROL",   OP_RM16_1,     IMPL(_ROL_RM16_1),      OP_RM32_1,     IMPL(_ROL_RM32_1));
+    buildSlash(0xD1, 1, "ROR",   OP_RM16_1,     IMPL(_ROR_RM16_1),      OP_RM32_1,     IMPL(_ROR_RM32_1));
+    buildSlash(0xD1, 2, "RCL",   OP_RM16_1,     IMPL(_RCL_RM16_1),      OP_RM32_1,     IMPL(_RCL_RM32_1));
+    buildSlash(0xD1, 3, "RCR",   OP_RM16_1,     IMPL(_RCR_RM16_1),      OP_RM32_1,     IMPL(_RCR_RM32_1));
+    buildSlash(0xD1, 4, "SHL",   OP_RM16_1,     IMPL(_SHL_RM16_1),      OP_RM32_1,     IMPL(_SHL_RM32_1));
+    buildSlash(0xD1, 5, "SHR",   OP_RM16_1,     IMPL(_SHR_RM16_1),      OP_RM32_1,     IMPL(_SHR_RM32_1));
+    buildSlash(0xD1, 6, "SHL",   OP_RM16_1,     IMPL(_SHL_RM16_1),      OP_RM32_1,     IMPL(_SHL_RM32_1)); // Undocumented
+    buildSlash(0xD1, 7, "SAR",   OP_RM16_1,     IMPL(_SAR_RM16_1),      OP_RM32_1,     IMPL(_SAR_RM32_1));
+
+    buildSlash(0xD2, 0, "ROL",   OP_RM8_CL,     IMPL(_ROL_RM8_CL));
+    buildSlash(0xD2, 1, "ROR",   OP_RM8_CL,     IMPL(_ROR_RM8_CL));
+    buildSlash(0xD2, 2, "RCL",   OP_RM8_CL,     IMPL(_RCL_RM8_CL));
+    buildSlash(0xD2, 3, "RCR",   OP_RM8_CL,     IMPL(_RCR_RM8_CL));
+    buildSlash(0xD2, 4, "SHL",   OP_RM8_CL,     IMPL(_SHL_RM8_CL));
+    buildSlash(0xD2, 5, "SHR",   OP_RM8_CL,     IMPL(_SHR_RM8_CL));
+    buildSlash(0xD2, 6, "SHL",   OP_RM8_CL,     IMPL(_SHL_RM8_CL)); // Undocumented
+    buildSlash(0xD2, 7, "SAR",   OP_RM8_CL,     IMPL(_SAR_RM8_CL));
+
+    buildSlash(0xD3, 0, "ROL",   OP_RM16_CL,    IMPL(_ROL_RM16_CL),     OP_RM32_CL,    IMPL(_ROL_RM32_CL));
+    buildSlash(0xD3, 1, "ROR",   OP_RM16_CL,    IMPL(_ROR_RM16_CL),     OP_RM32_CL,    IMPL(_ROR_RM32_CL));
+    buildSlash(0xD3, 2, "RCL",   OP_RM16_CL,    IMPL(_RCL_RM16_CL),     OP_RM32_CL,    IMPL(_RCL_RM32_CL));
+    buildSlash(0xD3, 3, "RCR",   OP_RM16_CL,    IMPL(_RCR_RM16_CL),     OP_RM32_CL,    IMPL(_RCR_RM32_CL));
+    buildSlash(0xD3, 4, "SHL",   OP_RM16_CL,    IMPL(_SHL_RM16_CL),     OP_RM32_CL,    IMPL(_SHL_RM32_CL));
+    buildSlash(0xD3, 5, "SHR",   OP_RM16_CL,    IMPL(_SHR_RM16_CL),     OP_RM32_CL,    IMPL(_SHR_RM32_CL));
+    buildSlash(0xD3, 6, "SHL",   OP_RM16_CL,    IMPL(_SHL_RM16_CL),     OP_RM32_CL,    IMPL(_SHL_RM32_CL)); // Undocumented
+    buildSlash(0xD3, 7, "SAR",   OP_RM16_CL,    IMPL(_SAR_RM16_CL),     OP_RM32_CL,    IMPL(_SAR_RM32_CL));
+
+    buildSlash(0xF6, 0, "TEST",  OP_RM8_imm8,   IMPL(_TEST_RM8_imm8));
+    buildSlash(0xF6, 1, "TEST",  OP_RM8_imm8,   IMPL(_TEST_RM8_imm8)); // Undocumented
+    buildSlash(0xF6, 2, "NOT",   OP_RM8,        IMPL(_NOT_RM8), LockPrefixAllowed);
+    buildSlash(0xF6, 3, "NEG",   OP_RM8,        IMPL(_NEG_RM8), LockPrefixAllowed);
+    buildSlash(0xF6, 4, "MUL",   OP_RM8,        IMPL(_MUL_RM8));
+    buildSlash(0xF6, 5, "IMUL",  OP_RM8,        IMPL(_IMUL_RM8));
+    buildSlash(0xF6, 6, "DIV",   OP_RM8,        IMPL(_DIV_RM8));
+    buildSlash(0xF6, 7, "IDIV",  OP_RM8,        IMPL(_IDIV_RM8));
+
+    buildSlash(0xF7, 0, "TEST",  OP_RM16_imm16, IMPL(_TEST_RM16_imm16), OP_RM32_imm32, IMPL(_TEST_RM32_imm32));
+    buildSlash(0xF7, 1, "TEST",  OP_RM16_imm16, IMPL(_TEST_RM16_imm16), OP_RM32_imm32, IMPL(_TEST_RM32_imm32)); // Undocumented
+    buildSlash(0xF7, 2, "NOT",   OP_RM16,       IMPL(_NOT_RM16),        OP_RM32,       IMPL(_NOT_RM32), LockPrefixAllowed);
+    buildSlash(0xF7, 3, "NEG",   OP_RM16,       IMPL(_NEG_RM16),        OP_RM32,       IMPL(_NEG_RM32), LockPrefixAllowed);
+    buildSlash(0xF7, 4, "MUL",   OP_RM16,       IMPL(_MUL_RM16),        OP_RM32,       IMPL(_MUL_RM32));
+    buildSlash(0xF7, 5, "IMUL",  OP_RM16,       IMPL(_IMUL_RM16),       OP_RM32,       IMPL(_IMUL_RM32));
+    buildSlash(0xF7, 6, "DIV",   OP_RM16,       IMPL(_DIV_RM16),        OP_RM32,       IMPL(_DIV_RM32));
+    buildSlash(0xF7, 7, "IDIV",  OP_RM16,       IMPL(_IDIV_RM16),       OP_RM32,       IMPL(_IDIV_RM32));
+
+    buildSlash(0xFE, 0, "INC",   OP_RM8,        IMPL(_INC_RM8), LockPrefixAllowed);
+    buildSlash(0xFE, 1, "DEC",   OP_RM8,        IMPL(_DEC_RM8), LockPrefixAllowed);
+
+    buildSlash(0xFF, 0, "INC",   OP_RM16,       IMPL(_INC_RM16),       OP_RM32,       IMPL(_INC_RM32), LockPrefixAllowed);
+    buildSlash(0xFF, 1, "DEC",   OP_RM16,       IMPL(_DEC_RM16),       OP_RM32,       IMPL(_DEC_RM32), LockPrefixAllowed);
+    buildSlash(0xFF, 2, "CALL",  OP_RM16,       IMPL(_CALL_RM16),      OP_RM32,       IMPL(_CALL_RM32));
+    buildSlash(0xFF, 3, "CALL",  OP_FAR_mem16,  IMPL(_CALL_FAR_mem16), OP_FAR_mem32,  IMPL(_CALL_FAR_mem32));
+    buildSlash(0xFF, 4, "JMP",   OP_RM16,       IMPL(_JMP_RM16),       OP_RM32,       IMPL(_JMP_RM32));
+    buildSlash(0xFF, 5, "JMP",   OP_FAR_mem16,  IMPL(_JMP_FAR_mem16),  OP_FAR_mem32,  IMPL(_JMP_FAR_mem32));
+    buildSlash(0xFF, 6, "PUSH",  OP_RM16,       IMPL(_PUSH_RM16),      OP_RM32,       IMPL(_PUSH_RM32));
 
     // Instructions starting with 0x0F are multi-byte opcodes.
-    build0FSlash(0x00, 0, "SLDT",  OP_RM16,      &CPU::_SLDT_RM16);
-    build0FSlash(0x00, 1, "STR",   OP_RM16,      &CPU::_STR_RM16);
-    build0FSlash(0x00, 2, "LLDT",  OP_RM16,      &CPU::_LLDT_RM16);
-    build0FSlash(0x00, 3, "LTR",   OP_RM16,      &CPU::_LTR_RM16);
-    build0FSlash(0x00, 4, "VERR",  OP_RM16,      &CPU::_VERR_RM16);
-    build0FSlash(0x00, 5, "VERW",  OP_RM16,      &CPU::_VERW_RM16);
-
-    build0FSlash(0x01, 0, "SGDT",  OP_RM16,      &CPU::_SGDT);
-    build0FSlash(0x01, 1, "SIDT",  OP_RM16,      &CPU::_SIDT);
-    build0FSlash(0x01, 2, "LGDT",  OP_RM16,      &CPU::_LGDT);
-    build0FSlash(0x01, 3, "LIDT",  OP_RM16,      &CPU::_LIDT);
-    build0FSlash(0x01, 4, "SMSW",  OP_RM16,      &CPU::_SMSW_RM16);
-    build0FSlash(0x01, 6, "LMSW",  OP_RM16,      &CPU::_LMSW_RM16);
-    build0FSlash(0x01, 7, "INVLPG",OP_RM32,      &CPU::_INVLPG);
-
-    build0FSlash(0xBA, 4, "BT",    OP_RM16_imm8, &CPU::_BT_RM16_imm8,  OP_RM32_imm8, &CPU::_BT_RM32_imm8, LockPrefixAllowed);
-    build0FSlash(0xBA, 5, "BTS",   OP_RM16_imm8, &CPU::_BTS_RM16_imm8, OP_RM32_imm8, &CPU::_BTS_RM32_imm8, LockPrefixAllowed);
-    build0FSlash(0xBA, 6, "BTR",   OP_RM16_imm8, &CPU::_BTR_RM16_imm8, OP_RM32_imm8, &CPU::_BTR_RM32_imm8, LockPrefixAllowed);
-    build0FSlash(0xBA, 7, "BTC",   OP_RM16_imm8, &CPU::_BTC_RM16_imm8, OP_RM32_imm8, &CPU::_BTC_RM32_imm8, LockPrefixAllowed);
-
-    build0F(0x02, "LAR",   OP_reg16_RM16,  &CPU::_LAR_reg16_RM16,  OP_reg32_RM32,  &CPU::_LAR_reg32_RM32);
-    build0F(0x03, "LSL",   OP_reg16_RM16,  &CPU::_LSL_reg16_RM16,  OP_reg32_RM32,  &CPU::_LSL_reg32_RM32);
-    build0F(0x06, "CLTS",  OP,             &CPU::_CLTS);
-    build0F(0x09, "WBINVD", OP,            &CPU::_WBINVD);
-    build0F(0x0B, "UD2",   OP,             &CPU::_UD2);
-
-    build0F(0x20, "MOV",   OP_reg32_CR,    &CPU::_MOV_reg32_CR);
-    build0F(0x21, "MOV",   OP_reg32_DR,    &CPU::_MOV_reg32_DR);
-    build0F(0x22, "MOV",   OP_CR_reg32,    &CPU::_MOV_CR_reg32);
-    build0F(0x23, "MOV",   OP_DR_reg32,    &CPU::_MOV_DR_reg32);
-
-    build0F(0x31, "RDTSC", OP,             &CPU::_RDTSC);
-
-    build0F(0x80, "JO",    OP_NEAR_imm,    &CPU::_Jcc_NEAR_imm);
-    build0F(0x81, "JNO",   OP_NEAR_imm,    &CPU::_Jcc_NEAR_imm);
-    build0F(0x82, "JC",    OP_NEAR_imm,    &CPU::_Jcc_NEAR_imm);
-    build0F(0x83, "JNC",   OP_NEAR_imm,    &CPU::_Jcc_NEAR_imm);
-    build0F(0x84, "JZ",    OP_NEAR_imm,    &CPU::_Jcc_NEAR_imm);
-    build0F(0x85, "JNZ",   OP_NEAR_imm,    &CPU::_Jcc_NEAR_imm);
-    build0F(0x86, "JNA",   OP_NEAR_imm,    &CPU::_Jcc_NEAR_imm);
-    build0F(0x87, "JA",    OP_NEAR_imm,    &CPU::_Jcc_NEAR_imm);
-    build0F(0x88, "JS",    OP_NEAR_imm,    &CPU::_Jcc_NEAR_imm);
-    build0F(0x89, "JNS",   OP_NEAR_imm,    &CPU::_Jcc_NEAR_imm);
-    build0F(0x8A, "JP",    OP_NEAR_imm,    &CPU::_Jcc_NEAR_imm);
-    build0F(0x8B, "JNP",   OP_NEAR_imm,    &CPU::_Jcc_NEAR_imm);
-    build0F(0x8C, "JL",    OP_NEAR_imm,    &CPU::_Jcc_NEAR_imm);
-    build0F(0x8D, "JNL",   OP_NEAR_imm,    &CPU::_Jcc_NEAR_imm);
-    build0F(0x8E, "JNG",   OP_NEAR_imm,    &CPU::_Jcc_NEAR_imm);
-    build0F(0x8F, "JG",    OP_NEAR_imm,    &CPU::_Jcc_NEAR_imm);
-
-    build0F(0x90, "SETO",  OP_RM8,         &CPU::_SETcc_RM8);
-    build0F(0x91, "SETNO", OP_RM8,         &CPU::_SETcc_RM8);
-    build0F(0x92, "SETC",  OP_RM8,         &CPU::_SETcc_RM8);
-    build0F(0x93, "SETNC", OP_RM8,         &CPU::_SETcc_RM8);
-    build0F(0x94, "SETZ",  OP_RM8,         &CPU::_SETcc_RM8);
-    build0F(0x95, "SETNZ", OP_RM8,         &CPU::_SETcc_RM8);
-    build0F(0x96, "SETNA", OP_RM8,         &CPU::_SETcc_RM8);
-    build0F(0x97, "SETA",  OP_RM8,         &CPU::_SETcc_RM8);
-    build0F(0x98, "SETS",  OP_RM8,         &CPU::_SETcc_RM8);
-    build0F(0x99, "SETNS", OP_RM8,         &CPU::_SETcc_RM8);
-    build0F(0x9A, "SETP",  OP_RM8,         &CPU::_SETcc_RM8);
-    build0F(0x9B, "SETNP", OP_RM8,         &CPU::_SETcc_RM8);
-    build0F(0x9C, "SETL",  OP_RM8,         &CPU::_SETcc_RM8);
-    build0F(0x9D, "SETNL", OP_RM8,         &CPU::_SETcc_RM8);
-    build0F(0x9E, "SETNG", OP_RM8,         &CPU::_SETcc_RM8);
-    build0F(0x9F, "SETG",  OP_RM8,         &CPU::_SETcc_RM8);
-
-    build0F(0xA0, "PUSH",  OP_FS,          &CPU::_PUSH_FS);
-    build0F(0xA1, "POP",   OP_FS,          &CPU::_POP_FS);
-    build0F(0xA2, "CPUID", OP,             &CPU::_CPUID);
-    build0F(0xA3, "BT",    OP_RM16_reg16,  &CPU::_BT_RM16_reg16,   OP_RM32_reg32,  &CPU::_BT_RM32_reg32);
-    build0F(0xA4, "SHLD",  OP_RM16_reg16_imm8,&CPU::_SHLD_RM16_reg16_imm8, OP_RM32_reg32_imm8,  &CPU::_SHLD_RM32_reg32_imm8);
-    build0F(0xA5, "SHLD",  OP_RM16_reg16_CL,&CPU::_SHLD_RM16_reg16_CL, OP_RM32_reg32_CL,  &CPU::_SHLD_RM32_reg32_CL);
-    build0F(0xA8, "PUSH",  OP_GS,          &CPU::_PUSH_GS);
-    build0F(0xA9, "POP",   OP_GS,          &CPU::_POP_GS);
-    build0F(0xAB, "BTS",   OP_RM16_reg16,  &CPU::_BTS_RM16_reg16,  OP_RM32_reg32,  &CPU::_BTS_RM32_reg32);
-    build0F(0xAC, "SHRD",  OP_RM16_reg16_imm8,&CPU::_SHRD_RM16_reg16_imm8, OP_RM32_reg32_imm8,  &CPU::_SHRD_RM32_reg32_imm8);
-    build0F(0xAD, "SHRD",  OP_RM16_reg16_CL,&CPU::_SHRD_RM16_reg16_CL, OP_RM32_reg32_CL,  &CPU::_SHRD_RM32_reg32_CL);
-    build0F(0xAF, "IMUL",  OP_reg16_RM16,  &CPU::_IMUL_reg16_RM16, OP_reg32_RM32,  &CPU::_IMUL_reg32_RM32);
-    build0F(0xB1, "CMPXCHG", OP_RM16_reg16, &CPU::_CMPXCHG_RM16_reg16, OP_RM32_reg32, &CPU::_CMPXCHG_RM32_reg32);
-    build0F(0xB2, "LSS",   OP_reg16_mem16, &CPU::_LSS_reg16_mem16, OP_reg32_mem32, &CPU::_LSS_reg32_mem32);
-    build0F(0xB3, "BTR",   OP_RM16_reg16,  &CPU::_BTR_RM16_reg16,  OP_RM32_reg32,  &CPU::_BTR_RM32_reg32);
-    build0F(0xB4, "LFS",   OP_reg16_mem16, &CPU::_LFS_reg16_mem16, OP_reg32_mem32, &CPU::_LFS_reg32_mem32);
-    build0F(0xB5, "LGS",   OP_reg16_mem16, &CPU::_LGS_reg16_mem16, OP_reg32_mem32, &CPU::_LGS_reg32_mem32);
-    build0F(0xB6, "MOVZX", OP_reg16_RM8,   &CPU::_MOVZX_reg16_RM8, OP_reg32_RM8,   &CPU::_MOVZX_reg32_RM8);
-    build0F(0xB7, "0xB7",  OP,             nullptr,       "MOVZX", OP_reg32_RM16,  &CPU::_MOVZX_reg32_RM16);
-    build0F(0xB9, "UD1",   OP,             &CPU::_UD1);
-    build0F(0xBB, "BTC",   OP_RM16_reg16,  &CPU::_BTC_RM16_reg16,  OP_RM32_reg32,  &CPU::_BTC_RM32_reg32);
-    build0F(0xBC, "BSF",   OP_reg16_RM16,  &CPU::_BSF_reg16_RM16,  OP_reg32_RM32,  &CPU::_BSF_reg32_RM32);
-    build0F(0xBD, "BSR",   OP_reg16_RM16,  &CPU::_BSR_reg16_RM16,  OP_reg32_RM32,  &CPU::_BSR_reg32_RM32);
-    build0F(0xBE, "MOVSX", OP_reg16_RM8,   &CPU::_MOVSX_reg16_RM8, OP_reg32_RM8,   &CPU::_MOVSX_reg32_RM8);
-    build0F(0xBF, "0xBF",  OP,             nullptr,       "MOVSX", OP_reg32_RM16,  &CPU::_MOVSX_reg32_RM16);
-    build0F(0xFF, "UD0",   OP,             &CPU::_UD0);
+    build0FSlash(0x00, 0, "SLDT",  OP_RM16,      IMPL(_SLDT_RM16));
+    build0FSlash(0x00, 1, "STR",   OP_RM16,      IMPL(_STR_RM16));
+    build0FSlash(0x00, 2, "LLDT",  OP_RM16,      IMPL(_LLDT_RM16));
+    build0FSlash(0x00, 3, "LTR",   OP_RM16,      IMPL(_LTR_RM16));
+    build0FSlash(0x00, 4, "VERR",  OP_RM16,      IMPL(_VERR_RM16));
+    build0FSlash(0x00, 5, "VERW",  OP_RM16,      IMPL(_VERW_RM16));
+
+    build0FSlash(0x01, 0, "SGDT",  OP_RM16,      IMPL(_SGDT));
+    build0FSlash(0x01, 1, "SIDT",  OP_RM16,      IMPL(_SIDT));
+    build0FSlash(0x01, 2, "LGDT",  OP_RM16,      IMPL(_LGDT));
+    build0FSlash(0x01, 3, "LIDT",  OP_RM16,      IMPL(_LIDT));
+    build0FSlash(0x01, 4, "SMSW",  OP_RM16,      IMPL(_SMSW_RM16));
+    build0FSlash(0x01, 6, "LMSW",  OP_RM16,      IMPL(_LMSW_RM16));
+    build0FSlash(0x01, 7, "INVLPG",OP_RM32,      IMPL(_INVLPG));
+
+    build0FSlash(0xBA, 4, "BT",    OP_RM16_imm8, IMPL(_BT_RM16_imm8),  OP_RM32_imm8, IMPL(_BT_RM32_imm8), LockPrefixAllowed);
+    build0FSlash(0xBA, 5, "BTS",   OP_RM16_imm8, IMPL(_BTS_RM16_imm8), OP_RM32_imm8, IMPL(_BTS_RM32_imm8), LockPrefixAllowed);
+    build0FSlash(0xBA, 6, "BTR",   OP_RM16_imm8, IMPL(_BTR_RM16_imm8), OP_RM32_imm8, IMPL(_BTR_RM32_imm8), LockPrefixAllowed);
+    build0FSlash(0xBA, 7, "BTC",   OP_RM16_imm8, IMPL(_BTC_RM16_imm8), OP_RM32_imm8, IMPL(_BTC_RM32_imm8), LockPrefixAllowed);
+
+    build0F(0x02, "LAR",   OP_reg16_RM16,  IMPL(_LAR_reg16_RM16),  OP_reg32_RM32,  IMPL(_LAR_reg32_RM32));
+    build0F(0x03, "LSL",   OP_reg16_RM16,  IMPL(_LSL_reg16_RM16),  OP_reg32_RM32,  IMPL(_LSL_reg32_RM32));
+    build0F(0x06, "CLTS",  OP,             IMPL(_CLTS));
+    build0F(0x09, "WBINVD", OP,            IMPL(_WBINVD));
+    build0F(0x0B, "UD2",   OP,             IMPL(_UD2));
+
+    build0F(0x20, "MOV",   OP_reg32_CR,    IMPL(_MOV_reg32_CR));
+    build0F(0x21, "MOV",   OP_reg32_DR,    IMPL(_MOV_reg32_DR));
+    build0F(0x22, "MOV",   OP_CR_reg32,    IMPL(_MOV_CR_reg32));
+    build0F(0x23, "MOV",   OP_DR_reg32,    IMPL(_MOV_DR_reg32));
+
+    build0F(0x31, "RDTSC", OP,             IMPL(_RDTSC));
+
+    build0F(0x80, "JO",    OP_NEAR_imm,    IMPL(_Jcc_NEAR_imm));
+    build0F(0x81, "JNO",   OP_NEAR_imm,    IMPL(_Jcc_NEAR_imm));
+    build0F(0x82, "JC",    OP_NEAR_imm,    IMPL(_Jcc_NEAR_imm));
+    build0F(0x83, "JNC",   OP_NEAR_imm,    IMPL(_Jcc_NEAR_imm));
+    build0F(0x84, "JZ",    OP_NEAR_imm,    IMPL(_Jcc_NEAR_imm));
+    build0F(0x85, "JNZ",   OP_NEAR_imm,    IMPL(_Jcc_NEAR_imm));
+    build0F(0x86, "JNA",   OP_NEAR_imm,    IMPL(_Jcc_NEAR_imm));
+    build0F(0x87, "JA",    OP_NEAR_imm,    IMPL(_Jcc_NEAR_imm));
+    build0F(0x88, "JS",    OP_NEAR_imm,    IMPL(_Jcc_NEAR_imm));
+    build0F(0x89, "JNS",   OP_NEAR_imm,    IMPL(_Jcc_NEAR_imm));
+    build0F(0x8A, "JP",    OP_NEAR_imm,    IMPL(_Jcc_NEAR_imm));
+    build0F(0x8B, "JNP",   OP_NEAR_imm,    IMPL(_Jcc_NEAR_imm));
+    build0F(0x8C, "JL",    OP_NEAR_imm,    IMPL(_Jcc_NEAR_imm));
+    build0F(0x8D, "JNL",   OP_NEAR_imm,    IMPL(_Jcc_NEAR_imm));
+    build0F(0x8E, "JNG",   OP_NEAR_imm,    IMPL(_Jcc_NEAR_imm));
+    build0F(0x8F, "JG",    OP_NEAR_imm,    IMPL(_Jcc_NEAR_imm));
+
+    build0F(0x90, "SETO",  OP_RM8,         IMPL(_SETcc_RM8));
+    build0F(0x91, "SETNO", OP_RM8,         IMPL(_SETcc_RM8));
+    build0F(0x92, "SETC",  OP_RM8,         IMPL(_SETcc_RM8));
+    build0F(0x93, "SETNC", OP_RM8,         IMPL(_SETcc_RM8));
+    build0F(0x94, "SETZ",  OP_RM8,         IMPL(_SETcc_RM8));
+    build0F(0x95, "SETNZ", OP_RM8,         IMPL(_SETcc_RM8));
+    build0F(0x96, "SETNA", OP_RM8,         IMPL(_SETcc_RM8));
+    build0F(0x97, "SETA",  OP_RM8,         IMPL(_SETcc_RM8));
+    build0F(0x98, "SETS",  OP_RM8,         IMPL(_SETcc_RM8));
+    build0F(0x99, "SETNS", OP_RM8,         IMPL(_SETcc_RM8));
+    build0F(0x9A, "SETP",  OP_RM8,         IMPL(_SETcc_RM8));
+    build0F(0x9B, "SETNP", OP_RM8,         IMPL(_SETcc_RM8));
+    build0F(0x9C, "SETL",  OP_RM8,         IMPL(_SETcc_RM8));
+    build0F(0x9D, "SETNL", OP_RM8,         IMPL(_SETcc_RM8));
+    build0F(0x9E, "SETNG", OP_RM8,         IMPL(_SETcc_RM8));
+    build0F(0x9F, "SETG",  OP_RM8,         IMPL(_SETcc_RM8));
+
+    build0F(0xA0, "PUSH",  OP_FS,          IMPL(_PUSH_FS));
+    build0F(0xA1, "POP",   OP_FS,          IMPL(_POP_FS));
+    build0F(0xA2, "CPUID", OP,             IMPL(_CPUID));
+    build0F(0xA3, "BT",    OP_RM16_reg16,  IMPL(_BT_RM16_reg16),   OP_RM32_reg32,  IMPL(_BT_RM32_reg32));
+    build0F(0xA4, "SHLD",  OP_RM16_reg16_imm8,IMPL(_SHLD_RM16_reg16_imm8), OP_RM32_reg32_imm8,  IMPL(_SHLD_RM32_reg32_imm8));
+    build0F(0xA5, "SHLD",  OP_RM16_reg16_CL,IMPL(_SHLD_RM16_reg16_CL), OP_RM32_reg32_CL,  IMPL(_SHLD_RM32_reg32_CL));
+    build0F(0xA8, "PUSH",  OP_GS,          IMPL(_PUSH_GS));
+    build0F(0xA9, "POP",   OP_GS,          IMPL(_POP_GS));
+    build0F(0xAB, "BTS",   OP_RM16_reg16,  IMPL(_BTS_RM16_reg16),  OP_RM32_reg32,  IMPL(_BTS_RM32_reg32));
+    build0F(0xAC, "SHRD",  OP_RM16_reg16_imm8,IMPL(_SHRD_RM16_reg16_imm8), OP_RM32_reg32_imm8,  IMPL(_SHRD_RM32_reg32_imm8));
+    build0F(0xAD, "SHRD",  OP_RM16_reg16_CL,IMPL(_SHRD_RM16_reg16_CL), OP_RM32_reg32_CL,  IMPL(_SHRD_RM32_reg32_CL));
+    build0F(0xAF, "IMUL",  OP_reg16_RM16,  IMPL(_IMUL_reg16_RM16), OP_reg32_RM32,  IMPL(_IMUL_reg32_RM32));
+    build0F(0xB1, "CMPXCHG", OP_RM16_reg16, IMPL(_CMPXCHG_RM16_reg16), OP_RM32_reg32, IMPL(_CMPXCHG_RM32_reg32));
+    build0F(0xB2, "LSS",   OP_reg16_mem16, IMPL(_LSS_reg16_mem16), OP_reg32_mem32, IMPL(_LSS_reg32_mem32));
+    build0F(0xB3, "BTR",   OP_RM16_reg16,  IMPL(_BTR_RM16_reg16),  OP_RM32_reg32,  IMPL(_BTR_RM32_reg32));
+    build0F(0xB4, "LFS",   OP_reg16_mem16, IMPL(_LFS_reg16_mem16), OP_reg32_mem32, IMPL(_LFS_reg32_mem32));
+    build0F(0xB5, "LGS",   OP_reg16_mem16, IMPL(_LGS_reg16_mem16), OP_reg32_mem32, IMPL(_LGS_reg32_mem32));
+    build0F(0xB6, "MOVZX", OP_reg16_RM8,   IMPL(_MOVZX_reg16_RM8), OP_reg32_RM8,   IMPL(_MOVZX_reg32_RM8));
+    build0F(0xB7, "0xB7",  OP,             nullptr,       "MOVZX", OP_reg32_RM16,  IMPL(_MOVZX_reg32_RM16));
+    build0F(0xB9, "UD1",   OP,             IMPL(_UD1));
+    build0F(0xBB, "BTC",   OP_RM16_reg16,  IMPL(_BTC_RM16_reg16),  OP_RM32_reg32,  IMPL(_BTC_RM32_reg32));
+    build0F(0xBC, "BSF",   OP_reg16_RM16,  IMPL(_BSF_reg16_RM16),  OP_reg32_RM32,  IMPL(_BSF_reg32_RM32));
+    build0F(0xBD, "BSR",   OP_reg16_RM16,  IMPL(_BSR_reg16_RM16),  OP_reg32_RM32,  IMPL(_BSR_reg32_RM32));
+    build0F(0xBE, "MOVSX", OP_reg16_RM8,   IMPL(_MOVSX_reg16_RM8), OP_reg32_RM8,   IMPL(_MOVSX_reg32_RM8));
+    build0F(0xBF, "0xBF",  OP,             nullptr,       "MOVSX", OP_reg32_RM16,  IMPL(_MOVSX_reg32_RM16));
+    build0F(0xFF, "UD0",   OP,             IMPL(_UD0));
 
     hasBuiltTables = true;
 }
@@ -1387,3 +1398,101 @@ DWORD SimpleInstructionStream::readInstruction32()
     WORD msw = readInstruction16();
     return weld<DWORD>(msw, lsw);
 }
+
+BYTE BoundedInstructionStream::readInstruction8()
+{
+    if (m_offset >= m_size) {
+        m_overrun = true;
+        return 0;
+    }
+    return m_data[m_offset++];
+}
+
+WORD BoundedInstructionStream::readInstruction16()
+{
+    BYTE lsb = readInstruction8();
+    BYTE msb = readInstruction8();
+    return weld<WORD>(msb, lsb);
+}
+
+DWORD BoundedInstructionStream::readInstruction32()
+{
+    WORD lsw = readInstruction16();
+    WORD msw = readInstruction16();
+    return weld<DWORD>(msw, lsw);
+}
+
+bool Instruction::endsBasicBlock() const
+{
+    if (m_op == 0x0F) {
+        switch (m_subOp) {
+        case 0x00: // SLDT/STR/LLDT/LTR/VERR/VERW
+        case 0x01: // SGDT/SIDT/LGDT/LIDT/SMSW/LMSW/INVLPG
+        case 0x06: // CLTS
+        case 0x20: case 0x21: case 0x22: case 0x23: // MOV to/from CRx/DRx
+            return true;
+        default:
+            return m_subOp >= 0x80 && m_subOp <= 0x8F; // Jcc
+        }
+    }
+
+    switch (m_op) {
+    case 0x17: // POP SS
+    case 0x6C: case 0x6D: case 0x6E: case 0x6F: // INS/OUTS
+    case 0x9A: // CALL far
+    case 0x9D: // POPF
+    case 0xC2: case 0xC3: case 0xCA: case 0xCB: // RET/RETF
+    case 0xCC: case 0xCD: case 0xCE: case 0xCF: // INT3/INT/INTO/IRET
+    case 0xE0: case 0xE1: case 0xE2: case 0xE3: // LOOPcc/JCXZ
+    case 0xE4: case 0xE5: case 0xE6: case 0xE7: // IN/OUT imm8
+    case 0xE8: case 0xE9: case 0xEA: case 0xEB: // CALL/JMP
+    case 0xEC: case 0xED: case 0xEE: case 0xEF: // IN/OUT DX
+    case 0xF1: // VKILL
+    case 0xF4: // HLT
+    case 0xFA: case 0xFB: // CLI/STI
+        return true;
+    case 0x8E: // MOV SS, r/m
+        return segmentRegisterIndex() == SegmentRegisterIndex::SS;
+    case 0xFF: // CALL/JMP near and far
+        return slash() >= 2 && slash() <= 5;
+    default:
+        return m_op >= 0x70 && m_op <= 0x7F; // Jcc
+    }
+}
+
+bool Instruction::isConditionalBranch() const
+{
+    if (m_op == 0x0F)
+        return m_subOp >= 0x80 && m_subOp <= 0x8F;
+    return m_op >= 0x70 && m_op <= 0x7F;
+}
+
+Instruction::Fusion Instruction::fusionWithBranch(const Instruction& branch) const
+{
+    if (m_hasLockPrefix || !branch.isConditionalBranch())
+        return Fusion::None;
+
+    // Only register and immediate operands, so that the pair can never fault halfway through.
+    bool registerOperand = m_hasRM && (rm() & 0xC0) == 0xC0;
+
+    switch (m_op) {
+    case 0x38: case 0x39: case 0x3A: case 0x3B: // CMP r/m, reg and CMP reg, r/m
+        return registerOperand ? Fusion::Compare : Fusion::None;
+    case 0x3C: case 0x3D: // CMP AL/eAX, imm
+        return Fusion::Compare;
+    case 0x80: case 0x81: case 0x83: // CMP r/m, imm
+        return registerOperand && slash() == 7 ? Fusion::Compare : Fusion::None;
+    case 0x84: case 0x85: // TEST r/m, reg
+        return registerOperand ? Fusion::Test : Fusion::None;
+    case 0xA8: case 0xA9: // TEST AL/eAX, imm
+        return Fusion::Test;
+    case 0xF6: case 0xF7: // TEST r/m, imm
+        return registerOperand && slash() == 0 ? Fusion::Test : Fusion::None;
+    case 0x48: case 0x49: case 0x4A: case 0x4B: case 0x4C: case 0x4D: case 0x4E: case 0x4F: // DEC reg
+        return Fusion::Decrement;
+    case 0xFE: case 0xFF: // DEC r/m
+        return registerOperand && slash() == 1 ? Fusion::Decrement : Fusion::None;
+    default:
+        return Fusion::None;
+    }
+}
@@ -33,7 +33,16 @@ class CPU;
 class Instruction;
 struct InstructionDescriptor;
 
+// Define this to dispatch through pointers-to-member instead, e.g to compare the two.
+//#define CT_MEMBER_FUNCTION_DISPATCH
+
+#ifdef CT_MEMBER_FUNCTION_DISPATCH
 typedef void (CPU::*InstructionImpl)(Instruction&);
+#else
+// A plain function per handler, with the CPU member function baked in at compile time.
+// This avoids the virtual-or-not check and this-adjustment of a pointer-to-member call.
+typedef void (*InstructionImpl)(CPU&, Instruction&);
+#endif
 
 struct Prefix {
 enum Op {
@@ -68,6 +77,27 @@ private:
     const BYTE* m_data { nullptr };
 };
 
+// Reads from a buffer of known size, yielding zeroes and setting the overrun flag past the end.
+class BoundedInstructionStream final : public InstructionStream {
+public:
+    BoundedInstructionStream(const BYTE* data, DWORD size)
+        : m_data(data)
+        , m_size(size)
+    { }
+
+    virtual BYTE readInstruction8() override;
+    virtual WORD readInstruction16() override;
+    virtual DWORD readInstruction32() override;
+
+    bool hasOverrun() const { return m_overrun; }
+
+private:
+    const BYTE* m_data { nullptr };
+    DWORD m_size { 0 };
+    DWORD m_offset { 0 };
+    bool m_overrun { false };
+};
+
 template<typename T>
 class RegisterAccessor {
 public:
@@ -160,6 +190,8 @@ public:
     bool hasAddressSizeOverridePrefix() const { return m_hasAddressSizeOverridePrefix; }
     bool hasOperandSizeOverridePrefix() const { return m_hasOperandSizeOverridePrefix; }
     bool hasLockPrefix() const { return m_hasLockPrefix; }
+    bool o32() const { return m_o32; }
+    bool a32() const { return m_a32; }
     bool hasRepPrefix() const { return m_repPrefix; }
     BYTE repPrefix() const { return m_repPrefix; }
 
@@ -206,6 +238,16 @@ public:
 
     BYTE cc() const { return m_hasSubOp ? m_subOp & 0xf : m_op & 0xf; }
 
+    // True for instructions after which the CPU must return to the main loop before continuing,
+    // e.g because they may transfer control, change interruptibility or alter address translation.
+    bool endsBasicBlock() const;
+
+    bool isConditionalBranch() const;
+
+    // Instructions that can be dispatched together with a following conditional branch.
+    enum class Fusion : BYTE { None, Compare, Test, Decrement };
+    Fusion fusionWithBranch(const Instruction& branch) const;
+
     QString toString(DWORD origin, bool x32) const;
 
 private:
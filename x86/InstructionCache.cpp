@@ -0,0 +1,143 @@
+// Computron x86 PC Emulator
+// Copyright (C) 2003-2018 Andreas Kling <awesomekling@gmail.com>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY ANDREAS KLING ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANDREAS KLING OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "InstructionCache.h"
+#include "debug.h"
+
+//#define DEBUG_INSTRUCTION_CACHE
+
+InstructionCache::~InstructionCache()
+{
+    clear();
+}
+
+void InstructionCache::setPhysicalMemorySize(DWORD size)
+{
+    invalidateAllPages();
+    m_pages.fill(nullptr, (size + pageSize - 1) / pageSize);
+}
+
+void InstructionCache::add(PhysicalAddress address, const Instruction& insn, bool o32, bool a32)
+{
+    DWORD pageIndex = address.get() / pageSize;
+    DWORD offset = address.get() & (pageSize - 1);
+    if (pageIndex >= (DWORD)m_pages.size())
+        return;
+    if ((offset + insn.length()) > pageSize)
+        return;
+
+    auto& page = ensurePage(pageIndex);
+    if (WORD index = page.index[offset]) {
+        page.entries[index - 1] = Entry(insn, o32, a32);
+        return;
+    }
+    page.entries.emplace_back(insn, o32, a32);
+    page.index[offset] = page.entries.size();
+}
+
+BasicBlock* InstructionCache::addBlock(PhysicalAddress address, BasicBlock* block)
+{
+    DWORD pageIndex = address.get() / pageSize;
+    DWORD offset = address.get() & (pageSize - 1);
+    if (pageIndex >= (DWORD)m_pages.size() || (offset + block->length) > pageSize) {
+        delete block;
+        return nullptr;
+    }
+
+    auto& page = ensurePage(pageIndex);
+    auto*& slot = page.blocks[offset];
+    if (slot) {
+        // The block being replaced (built for another operand/address size) may still be in use.
+        m_retiredBlocks.append(slot);
+        ++m_generation;
+    }
+    slot = block;
+    return block;
+}
+
+InstructionCache::CodePage& InstructionCache::ensurePage(DWORD pageIndex)
+{
+    auto*& page = m_pages[pageIndex];
+    if (!page) {
+        page = new CodePage;
+        memset(page->index, 0, sizeof(page->index));
+    }
+    return *page;
+}
+
+void BasicBlock::link(DWORD eip, BasicBlock* block, QWORD generation)
+{
+    for (auto& link : links) {
+        if (link.eip == eip) {
+            link.block = block;
+            link.generation = generation;
+            return;
+        }
+    }
+    auto& link = links[nextLinkToReplace];
+    nextLinkToReplace = (nextLinkToReplace + 1) % 2;
+    link.eip = eip;
+    link.block = block;
+    link.generation = generation;
+}
+
+void InstructionCache::invalidatePage(DWORD pageIndex)
+{
+    ASSERT(hasCodeOnPage(pageIndex));
+#ifdef DEBUG_INSTRUCTION_CACHE
+    vlog(LogCPU, "Invalidating %zu cached instruction(s) and %d block(s) on physical page %08x", m_pages[pageIndex]->entries.size(), m_pages[pageIndex]->blocks.size(), pageIndex * pageSize);
+#endif
+    m_retiredPages.append(m_pages[pageIndex]);
+    m_pages[pageIndex] = nullptr;
+    ++m_generation;
+}
+
+// Like invalidatePage(), for when all of physical memory changes under the CPU's feet (e.g a state restore.)
+void InstructionCache::invalidateAllPages()
+{
+    for (auto*& page : m_pages) {
+        if (!page)
+            continue;
+        m_retiredPages.append(page);
+        page = nullptr;
+    }
+    ++m_generation;
+}
+
+void InstructionCache::freeRetiredPages()
+{
+    qDeleteAll(m_retiredPages);
+    m_retiredPages.clear();
+    qDeleteAll(m_retiredBlocks);
+    m_retiredBlocks.clear();
+}
+
+void InstructionCache::clear()
+{
+    qDeleteAll(m_pages);
+    m_pages.fill(nullptr);
+    freeRetiredPages();
+    ++m_generation;
+}
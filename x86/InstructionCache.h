@@ -0,0 +1,152 @@
+// Computron x86 PC Emulator
+// Copyright (C) 2003-2018 Andreas Kling <awesomekling@gmail.com>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY ANDREAS KLING ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANDREAS KLING OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#pragma once
+
+#include "Instruction.h"
+#include <QtCore/QHash>
+#include <QtCore/QVector>
+#include <vector>
+
+// A run of pre-decoded instructions that execute back-to-back without needing to
+// return to the CPU main loop. Only the last instruction may be a block terminator.
+struct BasicBlock {
+    static const unsigned maxInstructions = 64;
+
+    BasicBlock(bool o, bool a) : o32(o), a32(a) { }
+
+    // Successor blocks by EIP, valid only while the cache generation is unchanged.
+    struct Link {
+        DWORD eip { 0 };
+        BasicBlock* block { nullptr };
+        QWORD generation { 0 };
+    };
+
+    BasicBlock* linkedBlock(DWORD eip, QWORD generation) const;
+    void link(DWORD eip, BasicBlock*, QWORD generation);
+
+    std::vector<Instruction> instructions;
+    DWORD length { 0 };
+    bool o32 { false };
+    bool a32 { false };
+    Link links[2];
+    unsigned nextLinkToReplace { 0 };
+
+    // If set, the last two instructions are dispatched as one by CPU::executeFusedPair().
+    Instruction::Fusion fusion { Instruction::Fusion::None };
+};
+
+// Pre-decoded instructions and basic blocks, indexed by the physical address of their first byte.
+// Only code that fits entirely within one physical page is cached, so that
+// invalidating a page on write is enough to catch self-modifying code.
+//
+// Invalidated pages and replaced blocks are retired rather than deleted, since the CPU may
+// still be executing one of their blocks. They are freed by collectRetiredPages() once that's no longer the case.
+// Every invalidation bumps the generation, which in turn breaks all block links.
+class InstructionCache {
+public:
+    static const DWORD pageSize = 4096;
+
+    InstructionCache() { }
+    ~InstructionCache();
+
+    void setPhysicalMemorySize(DWORD);
+
+    const Instruction* get(PhysicalAddress, bool o32, bool a32) const;
+    void add(PhysicalAddress, const Instruction&, bool o32, bool a32);
+
+    BasicBlock* getBlock(PhysicalAddress, bool o32, bool a32) const;
+    // Takes ownership of the block, returns nullptr if it couldn't be cached.
+    BasicBlock* addBlock(PhysicalAddress, BasicBlock*);
+
+    bool hasCodeOnPage(DWORD pageIndex) const { return pageIndex < (DWORD)m_pages.size() && m_pages[pageIndex]; }
+    void invalidatePage(DWORD pageIndex);
+    void invalidateAllPages();
+    void clear();
+
+    QWORD generation() const { return m_generation; }
+    void invalidateLinks() { ++m_generation; }
+    void collectRetiredPages() { if (UNLIKELY(!m_retiredPages.isEmpty() || !m_retiredBlocks.isEmpty())) freeRetiredPages(); }
+
+private:
+    void freeRetiredPages();
+
+    struct Entry {
+        Entry(const Instruction& i, bool o, bool a) : insn(i), o32(o), a32(a) { }
+        Instruction insn;
+        bool o32 { false };
+        bool a32 { false };
+    };
+
+    struct CodePage {
+        ~CodePage() { qDeleteAll(blocks); }
+        // 1-based indices into 'entries', 0 means no instruction starts at this offset.
+        WORD index[pageSize];
+        std::vector<Entry> entries;
+        QHash<WORD, BasicBlock*> blocks;
+    };
+
+    CodePage& ensurePage(DWORD pageIndex);
+
+    QVector<CodePage*> m_pages;
+    QVector<CodePage*> m_retiredPages;
+    QVector<BasicBlock*> m_retiredBlocks;
+    QWORD m_generation { 0 };
+};
+
+inline const Instruction* InstructionCache::get(PhysicalAddress address, bool o32, bool a32) const
+{
+    DWORD pageIndex = address.get() / pageSize;
+    if (!hasCodeOnPage(pageIndex))
+        return nullptr;
+    auto& page = *m_pages[pageIndex];
+    WORD index = page.index[address.get() & (pageSize - 1)];
+    if (!index)
+        return nullptr;
+    auto& entry = page.entries[index - 1];
+    if (entry.o32 != o32 || entry.a32 != a32)
+        return nullptr;
+    return &entry.insn;
+}
+
+inline BasicBlock* InstructionCache::getBlock(PhysicalAddress address, bool o32, bool a32) const
+{
+    DWORD pageIndex = address.get() / pageSize;
+    if (!hasCodeOnPage(pageIndex))
+        return nullptr;
+    auto* block = m_pages[pageIndex]->blocks.value(address.get() & (pageSize - 1), nullptr);
+    if (!block || block->o32 != o32 || block->a32 != a32)
+        return nullptr;
+    return block;
+}
+
+inline BasicBlock* BasicBlock::linkedBlock(DWORD eip, QWORD generation) const
+{
+    for (auto& link : links) {
+        if (link.block && link.eip == eip && link.generation == generation)
+            return link.block;
+    }
+    return nullptr;
+}
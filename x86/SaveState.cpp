@@ -0,0 +1,139 @@
+// Computron x86 PC Emulator
+// Copyright (C) 2003-2018 Andreas Kling <awesomekling@gmail.com>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY ANDREAS KLING ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANDREAS KLING OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "CPU.h"
+#include "machine.h"
+#include "EventScheduler.h"
+#include <QtCore/QDataStream>
+#include <QtCore/QFile>
+#include <sys/mman.h>
+
+void CPU::saveState(QDataStream& stream) const
+{
+    stream << m_baseMemorySize << m_extendedMemorySize << m_a20Enabled;
+    stream << (quint64)m_cycle;
+
+    stream << getEAX() << getECX() << getEDX() << getEBX() << getESP() << getEBP() << getESI() << getEDI();
+    stream << getEIP() << getEFlags();
+
+    stream << CS << DS << ES << SS << FS << GS;
+    for (auto& descriptor : m_descriptor)
+        descriptor.saveState(stream);
+    stream << m_addressSize32 << m_operandSize32 << m_stackSize32;
+
+    for (auto* tableRegister : { &m_GDTR, &m_IDTR, &m_LDTR })
+        stream << tableRegister->base().get() << tableRegister->limit() << tableRegister->selector();
+    stream << TR.selector << TR.base.get() << TR.limit << TR.is32Bit;
+
+    stream << m_CR0 << m_CR2 << m_CR3 << m_CR4;
+    stream << m_DR0 << m_DR1 << m_DR2 << m_DR3 << m_DR4 << m_DR5 << m_DR6 << m_DR7;
+}
+
+// A CPU saved while halted comes back running, as if an interrupt had woken it.
+void CPU::restoreState(QDataStream& stream)
+{
+    quint64 cycle;
+    stream >> m_baseMemorySize >> m_extendedMemorySize >> m_a20Enabled;
+    stream >> cycle;
+    machine().scheduler().rebaseVirtualClock(cycle);
+    m_cycle = cycle;
+    m_nextSchedulerCheckCycle = m_cycle;
+
+    DWORD registers[8];
+    DWORD eip;
+    DWORD eflags;
+    for (auto& value : registers)
+        stream >> value;
+    stream >> eip >> eflags;
+    setEAX(registers[0]);
+    setECX(registers[1]);
+    setEDX(registers[2]);
+    setEBX(registers[3]);
+    setESP(registers[4]);
+    setEBP(registers[5]);
+    setESI(registers[6]);
+    setEDI(registers[7]);
+    setEIP(eip);
+    setEFlags(eflags);
+
+    stream >> CS >> DS >> ES >> SS >> FS >> GS;
+    for (auto& descriptor : m_descriptor) {
+        descriptor.restoreState(stream);
+        updateSegmentAccessCache(descriptor);
+    }
+    stream >> m_addressSize32 >> m_operandSize32 >> m_stackSize32;
+
+    for (auto* tableRegister : { &m_GDTR, &m_IDTR, &m_LDTR }) {
+        DWORD base;
+        WORD limit;
+        WORD selector;
+        stream >> base >> limit >> selector;
+        tableRegister->setBase(LinearAddress(base));
+        tableRegister->setLimit(limit);
+        tableRegister->setSelector(selector);
+    }
+    DWORD trBase;
+    stream >> TR.selector >> trBase >> TR.limit >> TR.is32Bit;
+    TR.base = LinearAddress(trBase);
+
+    stream >> m_CR0 >> m_CR2 >> m_CR3 >> m_CR4;
+    stream >> m_DR0 >> m_DR1 >> m_DR2 >> m_DR3 >> m_DR4 >> m_DR5 >> m_DR6 >> m_DR7;
+
+    m_state = Alive;
+    saveBaseAddress();
+    m_idlePoll = IdlePoll();
+
+    flushTLB();
+    m_instructionCache.invalidateAllPages();
+    m_descriptorCache.clear();
+    recomputeMainLoopNeedsSlowStuff();
+}
+
+// Guest RAM is stored raw at the current (page aligned) position of the file.
+bool CPU::saveMemory(QIODevice& device) const
+{
+    return device.write(reinterpret_cast<const char*>(m_memory), m_memorySize) == (qint64)m_memorySize;
+}
+
+BYTE* CPU::loadMemoryImage(QFile& file, DWORD size)
+{
+    qint64 offset = file.pos();
+    if (file.size() - offset < (qint64)size)
+        return nullptr;
+
+    // Map the file copy-on-write, so pages are only read in as the guest touches them.
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file.handle(), offset);
+    if (memory != MAP_FAILED)
+        return static_cast<BYTE*>(memory);
+
+    memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+        return nullptr;
+    if (file.read(static_cast<char*>(memory), size) != (qint64)size) {
+        munmap(memory, size);
+        return nullptr;
+    }
+    return static_cast<BYTE*>(memory);
+}
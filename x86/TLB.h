@@ -0,0 +1,109 @@
+// Computron x86 PC Emulator
+// Copyright (C) 2003-2018 Andreas Kling <awesomekling@gmail.com>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY ANDREAS KLING ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANDREAS KLING OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#pragma once
+
+#include "types.h"
+
+// A direct-mapped cache of linear->physical page translations.
+//
+// Entries remember the combined PDE/PTE permissions, and whether the PTE is already
+// marked dirty, so that hits need no page table access at all. Like on real hardware,
+// the guest must invalidate entries (by reloading CR3 or using INVLPG) after editing
+// its page tables.
+//
+// Entries also hold a host pointer to the page when it's backed by plain memory, which lets
+// the CPU skip translation and physical memory dispatch altogether. With paging disabled,
+// the CPU fills in identity-mapped entries for this purpose only.
+class TLB {
+public:
+    static const DWORD entryCount = 1024;
+    static const DWORD pageSize = 4096;
+
+    enum Flags {
+        UserAccessible = 0x01,
+        Writable = 0x02,
+        Dirty = 0x04,
+        // The host page may be written to directly (i.e it's RAM, not ROM.)
+        HostWritable = 0x08,
+    };
+
+    struct Entry {
+        bool permits(bool isWrite, bool inUserMode, bool writeProtect) const
+        {
+            if (inUserMode && !(flags & UserAccessible))
+                return false;
+            if (isWrite) {
+                if ((inUserMode || writeProtect) && !(flags & Writable))
+                    return false;
+                // Writes to clean pages must go through the page walk, which sets the Dirty bit.
+                if (!(flags & Dirty))
+                    return false;
+            }
+            return true;
+        }
+
+        // Linear page address with bit 0 set for valid entries.
+        DWORD tag { 0 };
+        DWORD physicalPage { 0 };
+        BYTE flags { 0 };
+        BYTE* hostPage { nullptr };
+    };
+
+    const Entry* find(LinearAddress linearAddress) const
+    {
+        auto& entry = m_entries[indexFor(linearAddress)];
+        if (entry.tag != ((linearAddress.get() & 0xfffff000) | 1))
+            return nullptr;
+        return &entry;
+    }
+
+    void insert(LinearAddress linearAddress, DWORD physicalPage, BYTE flags, BYTE* hostPage)
+    {
+        auto& entry = m_entries[indexFor(linearAddress)];
+        entry.tag = (linearAddress.get() & 0xfffff000) | 1;
+        entry.physicalPage = physicalPage & 0xfffff000;
+        entry.flags = flags;
+        entry.hostPage = hostPage;
+    }
+
+    void flushPage(LinearAddress linearAddress)
+    {
+        auto& entry = m_entries[indexFor(linearAddress)];
+        if (entry.tag == ((linearAddress.get() & 0xfffff000) | 1))
+            entry.tag = 0;
+    }
+
+    void flush()
+    {
+        for (auto& entry : m_entries)
+            entry.tag = 0;
+    }
+
+private:
+    static DWORD indexFor(LinearAddress linearAddress) { return (linearAddress.get() >> 12) & (entryCount - 1); }
+
+    Entry m_entries[entryCount];
+};
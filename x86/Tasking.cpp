@@ -153,6 +153,7 @@ void CPU::taskSwitch(TSSDescriptor& incomingTSSDescriptor, JumpType source)
     // First, load all registers from TSS without validating contents.
     if (getPG()) {
         m_CR3 = incomingTSS.getCR3();
+        flushTLB();
     }
 
     m_LDTR.setSelector(incomingTSS.getLDT());
@@ -222,7 +223,7 @@ void CPU::taskSwitch(TSSDescriptor& incomingTSSDescriptor, JumpType source)
     if (csDescriptor.isCode()) {
         if (csDescriptor.isNonconformingCode()) {
             if (csDescriptor.DPL() != (getCS() & 3))
-                throw InvalidTSS(getCS(), QString("CS is non-conforming with DPL(%1) != RPL(%2)").arg(csDescriptor.DPL()).arg(getCS() & 3));
+                throw InvalidTSS(getCS(), "CS is non-conforming with DPL(%u) != RPL(%u)", csDescriptor.DPL(), getCS() & 3);
         } else if (csDescriptor.isConformingCode()) {
             if (csDescriptor.DPL() > (getCS() & 3))
                 throw InvalidTSS(getCS(), "CS is conforming with DPL > RPL");
@@ -239,7 +240,7 @@ void CPU::taskSwitch(TSSDescriptor& incomingTSSDescriptor, JumpType source)
         if (!ssDescriptor.present())
             throw StackFault(getSS(), "SS is not present");
         if (ssDescriptor.DPL() != incomingCPL)
-            throw InvalidTSS(getSS(), QString("SS DPL(%1) != CPL(%2)").arg(ssDescriptor.DPL()).arg(incomingCPL));
+            throw InvalidTSS(getSS(), "SS DPL(%u) != CPL(%u)", ssDescriptor.DPL(), incomingCPL);
     }
 
     if (!ldtDescriptor.isNull()) {
@@ -51,6 +51,39 @@ bool CPU::getSF() const
     return SF;
 }
 
+bool CPU::getCF() const
+{
+    if (m_dirtyFlags & Flag::CF) {
+        CF = (m_lastArithmeticResult >> m_lastArithmeticOpSize) & 1;
+        m_dirtyFlags &= ~Flag::CF;
+    }
+    return CF;
+}
+
+bool CPU::getAF() const
+{
+    if (m_dirtyFlags & Flag::AF) {
+        AF = ((m_lastArithmeticResult ^ m_lastArithmeticDest ^ m_lastArithmeticSrc) >> 4) & 1;
+        m_dirtyFlags &= ~Flag::AF;
+    }
+    return AF;
+}
+
+bool CPU::getOF() const
+{
+    if (m_dirtyFlags & Flag::OF) {
+        QWORD result = m_lastArithmeticResult;
+        QWORD dest = m_lastArithmeticDest;
+        QWORD src = m_lastArithmeticSrc;
+        if (m_lastArithmeticOperation == LazyOperation::Add)
+            OF = (((result ^ dest) & (result ^ src)) >> (m_lastArithmeticOpSize - 1)) & 1;
+        else
+            OF = (((result ^ dest) & (src ^ dest)) >> (m_lastArithmeticOpSize - 1)) & 1;
+        m_dirtyFlags &= ~Flag::OF;
+    }
+    return OF;
+}
+
 void CPU::updateFlags32(DWORD data)
 {
     m_dirtyFlags |= Flag::PF | Flag::ZF | Flag::SF;
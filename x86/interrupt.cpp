@@ -244,7 +244,7 @@ void CPU::protectedModeInterrupt(BYTE isr, InterruptSource source, QVariant erro
 
     if (source == InterruptSource::Internal) {
         if (gate.DPL() < getCPL()) {
-            throw GeneralProtectionFault(makeErrorCode(isr, 1, source), QString("Software interrupt trying to escalate privilege (CPL=%1, DPL=%2, VM=%3)").arg(getCPL()).arg(gate.DPL()).arg(getVM()));
+            throw GeneralProtectionFault(makeErrorCode(isr, 1, source), "Software interrupt trying to escalate privilege (CPL=%u, DPL=%u, VM=%u)", getCPL(), gate.DPL(), getVM());
         }
     }
 
@@ -289,7 +289,7 @@ void CPU::protectedModeInterrupt(BYTE isr, InterruptSource source, QVariant erro
 
     auto& codeDescriptor = descriptor.asCodeSegmentDescriptor();
     if (codeDescriptor.DPL() > getCPL()) {
-        throw GeneralProtectionFault(makeErrorCode(gate.selector(), 0, source), QString("Interrupt gate to segment with DPL(%1)>CPL(%2)").arg(codeDescriptor.DPL()).arg(getCPL()));
+        throw GeneralProtectionFault(makeErrorCode(gate.selector(), 0, source), "Interrupt gate to segment with DPL(%u)>CPL(%u)", codeDescriptor.DPL(), getCPL());
     }
 
     if (!codeDescriptor.present()) {
@@ -341,7 +341,7 @@ void CPU::protectedModeInterrupt(BYTE isr, InterruptSource source, QVariant erro
         }
 
         if (newSSDescriptor.DPL() != descriptor.DPL()) {
-            throw InvalidTSS(makeErrorCode(newSS, 0, source), QString("New ss DPL(%1) != code segment DPL(%2)").arg(newSSDescriptor.DPL()).arg(descriptor.DPL()));
+            throw InvalidTSS(makeErrorCode(newSS, 0, source), "New ss DPL(%u) != code segment DPL(%u)", newSSDescriptor.DPL(), descriptor.DPL());
         }
 
         if (!newSSDescriptor.isData() || !newSSDescriptor.asDataSegmentDescriptor().writable()) {
@@ -432,11 +432,11 @@ void CPU::interruptFromVM86Mode(Gate& gate, DWORD offset, CodeSegmentDescriptor&
     }
 
     if ((newSS & 3) != 0) {
-        throw InvalidTSS(makeErrorCode(newSS, 0, source), QString("New ss RPL(%1) != 0").arg(newSS & 3));
+        throw InvalidTSS(makeErrorCode(newSS, 0, source), "New ss RPL(%u) != 0", newSS & 3);
     }
 
     if (newSSDescriptor.DPL() != 0) {
-        throw InvalidTSS(makeErrorCode(newSS, 0, source), QString("New ss DPL(%1) != 0").arg(newSSDescriptor.DPL()));
+        throw InvalidTSS(makeErrorCode(newSS, 0, source), "New ss DPL(%u) != 0", newSSDescriptor.DPL());
     }
 
     if (!newSSDescriptor.isData() || !newSSDescriptor.asDataSegmentDescriptor().writable()) {
@@ -533,7 +533,7 @@ void CPU::protectedIRET(TransactionalPopper& popper, LogicalAddress address)
     }
 
     if (selectorRPL < getCPL())
-        throw GeneralProtectionFault(selector & 0xfffc, QString("IRET with RPL(%1) < CPL(%2)").arg(selectorRPL).arg(getCPL()));
+        throw GeneralProtectionFault(selector & 0xfffc, "IRET with RPL(%u) < CPL(%u)", selectorRPL, getCPL());
 
     auto& codeSegment = descriptor.asCodeSegmentDescriptor();
 
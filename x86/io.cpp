@@ -147,6 +147,7 @@ void CPU::out(WORD port, T data)
 template<typename T> T CPU::in(WORD port)
 {
     validateIOAccess<T>(port);
+    noteIdlePoll();
 
     T data;
     if (auto* device = machine().inputDeviceForPort(port)) {
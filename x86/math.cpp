@@ -29,11 +29,7 @@ template<typename T>
 QWORD CPU::doADD(T dest, T src)
 {
     QWORD result = (QWORD)dest + (QWORD)src;
-    mathFlags(result, dest, src);
-    setOF(((
-          ((result)^(dest)) &
-          ((result)^(src))
-         )>>(TypeTrivia<T>::bits - 1))&1);
+    mathFlags<T>(result, dest, src);
     return result;
 }
 
@@ -42,11 +38,7 @@ QWORD CPU::doADC(T dest, T src)
 {
     QWORD result = (QWORD)dest + (QWORD)src + (QWORD)getCF();
 
-    mathFlags(result, dest, src);
-    setOF(((
-          ((result)^(dest)) &
-          ((result)^(src))
-         )>>(TypeTrivia<T>::bits - 1))&1);
+    mathFlags<T>(result, dest, src);
     return result;
 }
 
@@ -183,7 +175,10 @@ void CPU::doDIV(T dividendHigh, T dividendLow, T divisor, T& quotient, T& remain
     DT dividend = weld<DT>(dividendHigh, dividendLow);
     DT result = dividend / divisor;
     if (result > std::numeric_limits<T>::max() || result < std::numeric_limits<T>::min()) {
-        throw DivideError(QString("Divide overflow (%1 / %2 = %3 { range = %4 - %5 })").arg(dividend).arg(divisor).arg(result).arg(std::numeric_limits<T>::min()).arg(std::numeric_limits<T>::max()));
+        if constexpr (std::numeric_limits<T>::is_signed)
+            throw DivideError("Divide overflow (%lld / %lld = %lld { range = %lld - %lld })", (long long)dividend, (long long)divisor, (long long)result, (long long)std::numeric_limits<T>::min(), (long long)std::numeric_limits<T>::max());
+        else
+            throw DivideError("Divide overflow (%llu / %llu = %llu { range = %llu - %llu })", (unsigned long long)dividend, (unsigned long long)divisor, (unsigned long long)result, (unsigned long long)std::numeric_limits<T>::min(), (unsigned long long)std::numeric_limits<T>::max());
     }
 
     quotient = result;
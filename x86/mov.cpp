@@ -125,7 +125,7 @@ void CPU::_MOV_reg32_CR(Instruction& insn)
         // table (PDPT) and the loading of a control register causes the
         // PDPT to be loaded into the processor.
         if (getCPL() != 0) {
-            throw GeneralProtectionFault(0, QString("MOV reg32, CRx with CPL!=0(%1)").arg(getCPL()));
+            throw GeneralProtectionFault(0, "MOV reg32, CRx with CPL!=0(%u)", getCPL());
         }
     } else {
         // FIXME: GP(0) conditions:
@@ -160,7 +160,7 @@ void CPU::_MOV_CR_reg32(Instruction& insn)
         // table (PDPT) and the loading of a control register causes the
         // PDPT to be loaded into the processor.
         if (getCPL() != 0) {
-            throw GeneralProtectionFault(0, QString("MOV CRx, reg32 with CPL!=0(%1)").arg(getCPL()));
+            throw GeneralProtectionFault(0, "MOV CRx, reg32 with CPL!=0(%u)", getCPL());
         }
     } else {
         // FIXME: GP(0) conditions:
@@ -176,8 +176,11 @@ void CPU::_MOV_CR_reg32(Instruction& insn)
     }
     setControlRegister(crIndex, readRegister<DWORD>(static_cast<CPU::RegisterIndex32>(insn.rm() & 7)));
 
-    if (crIndex == 0 || crIndex == 3)
+    if (crIndex == 0 || crIndex == 3) {
+        // CR0 may have changed PG or WP, and CR3 points to new page tables.
+        flushTLB();
         updateCodeSegmentCache();
+    }
 
 #ifdef VERBOSE_DEBUG
     vlog(LogCPU, "MOV CR%u <- %08X", crIndex, getControlRegister(crIndex));
@@ -195,7 +198,7 @@ void CPU::_MOV_reg32_DR(Instruction& insn)
 
     if (getPE()) {
         if (getCPL() != 0) {
-            throw GeneralProtectionFault(0, QString("MOV reg32, DRx with CPL!=0(%1)").arg(getCPL()));
+            throw GeneralProtectionFault(0, "MOV reg32, DRx with CPL!=0(%u)", getCPL());
         }
     }
 
@@ -214,7 +217,7 @@ void CPU::_MOV_DR_reg32(Instruction& insn)
 
     if (getPE()) {
         if (getCPL() != 0) {
-            throw GeneralProtectionFault(0, QString("MOV DRx, reg32 with CPL!=0(%1)").arg(getCPL()));
+            throw GeneralProtectionFault(0, "MOV DRx, reg32 with CPL!=0(%u)", getCPL());
         }
     }
 
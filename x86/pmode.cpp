@@ -24,13 +24,14 @@
 
 #include "CPU.h"
 #include "debugger.h"
+#include <stdarg.h>
 
 //#define DEBUG_DESCRIPTOR_TABLES
 
 void CPU::doSGDTorSIDT(Instruction& insn, DescriptorTableRegister& table)
 {
     if (insn.modrm().isRegister())
-        throw InvalidOpcode(QString("%1 with register destination").arg(insn.mnemonic()));
+        throw InvalidOpcode("%s with register destination", &table == &m_GDTR ? "SGDT" : "SIDT");
 
     snoop(insn.modrm().segment(), insn.modrm().offset(), MemoryAccessType::Write);
     snoop(insn.modrm().segment(), insn.modrm().offset() + 6, MemoryAccessType::Write);
@@ -110,10 +111,10 @@ void CPU::dumpLDT()
 void CPU::doLGDTorLIDT(Instruction& insn, DescriptorTableRegister& table)
 {
     if (insn.modrm().isRegister())
-        throw InvalidOpcode(QString("%1 with register source").arg(insn.mnemonic()));
+        throw InvalidOpcode("%s with register source", &table == &m_GDTR ? "LGDT" : "LIDT");
 
     if (getCPL() != 0)
-        throw GeneralProtectionFault(0, QString("%1 with CPL != 0").arg(insn.mnemonic()));
+        throw GeneralProtectionFault(0, "%s with CPL != 0", &table == &m_GDTR ? "LGDT" : "LIDT");
 
     DWORD base = readMemory32(insn.modrm().segment(), insn.modrm().offset() + 2);
     WORD limit = readMemory16(insn.modrm().segment(), insn.modrm().offset());
@@ -161,7 +162,7 @@ void CPU::_CLTS(Instruction&)
 {
     if (getPE()) {
         if (getCPL() != 0) {
-            throw GeneralProtectionFault(0, QString("CLTS with CPL!=0(%1)").arg(getCPL()));
+            throw GeneralProtectionFault(0, "CLTS with CPL!=0(%u)", getCPL());
         }
     }
     m_CR0 &= ~(1 << 3);
@@ -171,7 +172,7 @@ void CPU::_LMSW_RM16(Instruction& insn)
 {
     if (getPE()) {
         if (getCPL() != 0) {
-            throw GeneralProtectionFault(0, QString("LMSW with CPL!=0(%1)").arg(getCPL()));
+            throw GeneralProtectionFault(0, "LMSW with CPL!=0(%u)", getCPL());
         }
     }
 
@@ -332,15 +333,19 @@ void CPU::raiseException(const Exception& e)
     }
 }
 
-Exception CPU::GeneralProtectionFault(WORD code, const QString& reason)
+Exception CPU::GeneralProtectionFault(WORD code, const char* reason, ...)
 {
     WORD selector = code & 0xfff8;
     bool TI = code & 4;
     bool I = code & 2;
     bool EX = code & 1;
 
-    if (options.log_exceptions)
-        vlog(LogCPU, "Exception: #GP(%04x) selector=%04X, TI=%u, I=%u, EX=%u :: %s", code, selector, TI, I, EX, qPrintable(reason));
+    if (options.log_exceptions) {
+        va_list ap;
+        va_start(ap, reason);
+        vlog(LogCPU, "Exception: #GP(%04x) selector=%04X, TI=%u, I=%u, EX=%u :: %s", code, selector, TI, I, EX, qPrintable(QString::vasprintf(reason, ap)));
+        va_end(ap);
+    }
     if (options.crashOnGPF) {
         dumpAll();
         vlog(LogAlert, "CRASH ON GPF");
@@ -349,45 +354,69 @@ Exception CPU::GeneralProtectionFault(WORD code, const QString& reason)
     return Exception(0xd, code, reason);
 }
 
-Exception CPU::StackFault(WORD selector, const QString& reason)
+Exception CPU::StackFault(WORD selector, const char* reason, ...)
 {
-    if (options.log_exceptions)
-        vlog(LogCPU, "Exception: #SS(%04x) :: %s", selector, qPrintable(reason));
+    if (options.log_exceptions) {
+        va_list ap;
+        va_start(ap, reason);
+        vlog(LogCPU, "Exception: #SS(%04x) :: %s", selector, qPrintable(QString::vasprintf(reason, ap)));
+        va_end(ap);
+    }
     return Exception(0xc, selector, reason);
 }
 
-Exception CPU::NotPresent(WORD selector, const QString& reason)
+Exception CPU::NotPresent(WORD selector, const char* reason, ...)
 {
-    if (options.log_exceptions)
-        vlog(LogCPU, "Exception: #NP(%04x) :: %s", selector, qPrintable(reason));
+    if (options.log_exceptions) {
+        va_list ap;
+        va_start(ap, reason);
+        vlog(LogCPU, "Exception: #NP(%04x) :: %s", selector, qPrintable(QString::vasprintf(reason, ap)));
+        va_end(ap);
+    }
     return Exception(0xb, selector, reason);
 }
 
-Exception CPU::InvalidOpcode(const QString& reason)
+Exception CPU::InvalidOpcode(const char* reason, ...)
 {
-    if (options.log_exceptions)
-        vlog(LogCPU, "Exception: #UD :: %s", qPrintable(reason));
+    if (options.log_exceptions) {
+        va_list ap;
+        va_start(ap, reason);
+        vlog(LogCPU, "Exception: #UD :: %s", qPrintable(QString::vasprintf(reason, ap)));
+        va_end(ap);
+    }
     return Exception(0x6, reason);
 }
 
-Exception CPU::BoundRangeExceeded(const QString& reason)
+Exception CPU::BoundRangeExceeded(const char* reason, ...)
 {
-    if (options.log_exceptions)
-        vlog(LogCPU, "Exception: #BR :: %s", qPrintable(reason));
+    if (options.log_exceptions) {
+        va_list ap;
+        va_start(ap, reason);
+        vlog(LogCPU, "Exception: #BR :: %s", qPrintable(QString::vasprintf(reason, ap)));
+        va_end(ap);
+    }
     return Exception(0x5, reason);
 }
 
-Exception CPU::InvalidTSS(WORD selector, const QString& reason)
+Exception CPU::InvalidTSS(WORD selector, const char* reason, ...)
 {
-    if (options.log_exceptions)
-        vlog(LogCPU, "Exception: #TS(%04x) :: %s", selector, qPrintable(reason));
+    if (options.log_exceptions) {
+        va_list ap;
+        va_start(ap, reason);
+        vlog(LogCPU, "Exception: #TS(%04x) :: %s", selector, qPrintable(QString::vasprintf(reason, ap)));
+        va_end(ap);
+    }
     return Exception(0xa, selector, reason);
 }
 
-Exception CPU::DivideError(const QString& reason)
+Exception CPU::DivideError(const char* reason, ...)
 {
-    if (options.log_exceptions)
-        vlog(LogCPU, "Exception: #DE :: %s", qPrintable(reason));
+    if (options.log_exceptions) {
+        va_list ap;
+        va_start(ap, reason);
+        vlog(LogCPU, "Exception: #DE :: %s", qPrintable(QString::vasprintf(reason, ap)));
+        va_end(ap);
+    }
     return Exception(0x0, reason);
 }
 
@@ -407,13 +436,13 @@ void CPU::validateSegmentLoad(SegmentRegisterIndex reg, WORD selector, const Des
             throw GeneralProtectionFault(0, "ss loaded with null descriptor");
         }
         if (selectorRPL != getCPL()) {
-            throw GeneralProtectionFault(selector & 0xfffc, QString("ss selector RPL(%1) != CPL(%2)").arg(selectorRPL).arg(getCPL()));
+            throw GeneralProtectionFault(selector & 0xfffc, "ss selector RPL(%u) != CPL(%u)", selectorRPL, getCPL());
         }
         if (!descriptor.isData() || !descriptor.asDataSegmentDescriptor().writable()) {
             throw GeneralProtectionFault(selector & 0xfffc, "ss loaded with something other than a writable data segment");
         }
         if (descriptor.DPL() != getCPL()) {
-            throw GeneralProtectionFault(selector & 0xfffc, QString("ss selector leads to descriptor with DPL(%1) != CPL(%2)").arg(descriptor.DPL()).arg(getCPL()));
+            throw GeneralProtectionFault(selector & 0xfffc, "ss selector leads to descriptor with DPL(%u) != CPL(%u)", descriptor.DPL(), getCPL());
         }
         if (!descriptor.present()) {
             throw StackFault(selector & 0xfffc, "ss loaded with non-present segment");
@@ -429,27 +458,48 @@ void CPU::validateSegmentLoad(SegmentRegisterIndex reg, WORD selector, const Des
         || reg == SegmentRegisterIndex::FS
         || reg == SegmentRegisterIndex::GS) {
         if (!descriptor.isData() && (descriptor.isCode() && !descriptor.asCodeSegmentDescriptor().readable())) {
-            throw GeneralProtectionFault(selector & 0xfffc, QString("%1 loaded with non-data or non-readable code segment").arg(registerName(reg)));
+            throw GeneralProtectionFault(selector & 0xfffc, "%s loaded with non-data or non-readable code segment", registerName(reg));
         }
         if (descriptor.isData() || descriptor.isNonconformingCode()) {
             if (selectorRPL > descriptor.DPL()) {
-                throw GeneralProtectionFault(selector & 0xfffc, QString("%1 loaded with data or non-conforming code segment and RPL > DPL").arg(registerName(reg)));
+                throw GeneralProtectionFault(selector & 0xfffc, "%s loaded with data or non-conforming code segment and RPL > DPL", registerName(reg));
             }
             if (getCPL() > descriptor.DPL()) {
-                throw GeneralProtectionFault(selector & 0xfffc, QString("%1 loaded with data or non-conforming code segment and CPL > DPL").arg(registerName(reg)));
+                throw GeneralProtectionFault(selector & 0xfffc, "%s loaded with data or non-conforming code segment and CPL > DPL", registerName(reg));
             }
         }
         if (!descriptor.present()) {
-            throw NotPresent(selector & 0xfffc, QString("%1 loaded with non-present segment").arg(registerName(reg)));
+            throw NotPresent(selector & 0xfffc, "%s loaded with non-present segment", registerName(reg));
         }
     }
 
     if (!descriptor.isNull() && !descriptor.isSegmentDescriptor()) {
         dumpDescriptor(descriptor);
-        throw GeneralProtectionFault(selector & 0xfffc, QString("%1 loaded with system segment").arg(registerName(reg)));
+        throw GeneralProtectionFault(selector & 0xfffc, "%s loaded with system segment", registerName(reg));
     }
 }
 
+void CPU::updateSegmentAccessCache(SegmentDescriptor& descriptor)
+{
+    // Mirrors the type checks in validateAddress(); anything not marked here takes the full path there.
+    descriptor.m_permittedAccess = 0;
+    descriptor.m_uncheckedAccess = 0;
+    if (descriptor.isNull())
+        return;
+
+    BYTE permitted = 1 << (int)MemoryAccessType::InternalPointer;
+    if (descriptor.isData() || descriptor.asCodeSegmentDescriptor().readable())
+        permitted |= 1 << (int)MemoryAccessType::Read;
+    if (descriptor.isData() && descriptor.asDataSegmentDescriptor().writable())
+        permitted |= 1 << (int)MemoryAccessType::Write;
+    if (descriptor.isCode())
+        permitted |= 1 << (int)MemoryAccessType::Execute;
+
+    descriptor.m_permittedAccess = permitted;
+    if (descriptor.isFlat())
+        descriptor.m_uncheckedAccess = permitted;
+}
+
 void CPU::writeSegmentRegister(SegmentRegisterIndex segreg, WORD selector)
 {
     if ((int)segreg >= 6) {
@@ -468,11 +518,13 @@ void CPU::writeSegmentRegister(SegmentRegisterIndex segreg, WORD selector)
 
     if (descriptor.isNull()) {
         cachedDescriptor(segreg) = descriptor.asSegmentDescriptor();
+        updateSegmentAccessCache(cachedDescriptor(segreg));
         return;
     }
 
     ASSERT(descriptor.isSegmentDescriptor());
     cachedDescriptor(segreg) = descriptor.asSegmentDescriptor();
+    updateSegmentAccessCache(cachedDescriptor(segreg));
     if (options.pedebug) {
         if (getPE()) {
             vlog(LogCPU, "%s loaded with %04x { type:%02X, base:%08X, limit:%08X }",
@@ -24,21 +24,28 @@
 
 #include "CPU.h"
 #include "pic.h"
+#include <string.h>
 
-template<typename F>
-void CPU::doOnceOrRepeatedly(Instruction& insn, bool careAboutZF, F func)
+template<typename F, typename BulkF>
+void CPU::doOnceOrRepeatedly(Instruction& insn, bool careAboutZF, F func, BulkF bulkFunc)
 {
     if (!insn.hasRepPrefix()) {
         func();
         return;
     }
-    while (readRegisterForAddressSize(RegisterCX)) {
+    while (DWORD count = readRegisterForAddressSize(RegisterCX)) {
         if (getIF() && PIC::hasPendingIRQ() && !PIC::isIgnoringAllIRQs()) {
             throw HardwareInterruptDuringREP();
         }
-        func();
-        ++m_cycle;
-        decrementCXForAddressSize();
+        // The bulk function processes as many elements as it can directly in host memory,
+        // stopping early where REPZ/REPNZ would. If it can't do anything, take the slow path.
+        count = bulkFunc(count);
+        if (!count) {
+            func();
+            count = 1;
+        }
+        m_cycle += count;
+        writeRegisterForAddressSize(RegisterCX, readRegisterForAddressSize(RegisterCX) - count);
         if (careAboutZF) {
             if (insn.repPrefix() == Prefix::REPZ && !getZF())
                 break;
@@ -48,12 +55,33 @@ void CPU::doOnceOrRepeatedly(Instruction& insn, bool careAboutZF, F func)
     }
 }
 
+template<typename F>
+void CPU::doOnceOrRepeatedly(Instruction& insn, bool careAboutZF, F func)
+{
+    doOnceOrRepeatedly(insn, careAboutZF, func, [] (DWORD) { return 0u; });
+}
+
+// Host pointer to the i'th element of a chunk, walking in the direction of DF.
+template<typename T>
+static inline BYTE* stringElement(BYTE* first, DWORD index, bool df)
+{
+    return df ? first - index * sizeof(T) : first + index * sizeof(T);
+}
+
 template<typename T>
 void CPU::doLODS(Instruction& insn)
 {
     doOnceOrRepeatedly(insn, false, [this] () {
         writeRegister<T>(RegisterAL, readMemory<T>(currentSegment(), readRegisterForAddressSize(RegisterSI)));
         stepRegisterForAddressSize(RegisterSI, sizeof(T));
+    }, [this] (DWORD count) -> DWORD {
+        auto* src = hostPointerForStringChunk<T>(currentSegment(), readRegisterForAddressSize(RegisterSI), count, MemoryAccessType::Read);
+        if (!src)
+            return 0;
+        // Only the last element loaded is observable.
+        writeRegister<T>(RegisterAL, *reinterpret_cast<const T*>(stringElement<T>(src, count - 1, getDF())));
+        stepRegisterForAddressSize(RegisterSI, count * sizeof(T));
+        return count;
     });
 }
 
@@ -63,6 +91,20 @@ void CPU::doSTOS(Instruction& insn)
     doOnceOrRepeatedly(insn, false, [this] () {
         writeMemory<T>(SegmentRegisterIndex::ES, readRegisterForAddressSize(RegisterDI), readRegister<T>(RegisterAL));
         stepRegisterForAddressSize(RegisterDI, sizeof(T));
+    }, [this] (DWORD count) -> DWORD {
+        auto* dest = hostPointerForStringChunk<T>(SegmentRegisterIndex::ES, readRegisterForAddressSize(RegisterDI), count, MemoryAccessType::Write);
+        if (!dest)
+            return 0;
+        BYTE* low = getDF() ? stringElement<T>(dest, count - 1, true) : dest;
+        T value = readRegister<T>(RegisterAL);
+        if constexpr (sizeof(T) == 1) {
+            memset(low, value, count);
+        } else {
+            for (DWORD i = 0; i < count; ++i)
+                memcpy(low + i * sizeof(T), &value, sizeof(T));
+        }
+        stepRegisterForAddressSize(RegisterDI, count * sizeof(T));
+        return count;
     });
 }
 
@@ -76,6 +118,31 @@ void CPU::doCMPS(Instruction& insn)
         stepRegisterForAddressSize(RegisterSI, sizeof(T));
         stepRegisterForAddressSize(RegisterDI, sizeof(T));
         cmpFlags<T>(src - dest, src, dest);
+    }, [this, &insn] (DWORD count) -> DWORD {
+        auto* srcPtr = hostPointerForStringChunk<T>(currentSegment(), readRegisterForAddressSize(RegisterSI), count, MemoryAccessType::Read);
+        if (!srcPtr)
+            return 0;
+        auto* destPtr = hostPointerForStringChunk<T>(SegmentRegisterIndex::ES, readRegisterForAddressSize(RegisterDI), count, MemoryAccessType::Read);
+        if (!destPtr)
+            return 0;
+        bool df = getDF();
+        bool stopOnEqual = insn.repPrefix() == Prefix::REPNZ;
+        DWORD index = 0;
+        // Fast-forward over a fully matching REPZ chunk; the loop below then only compares the last element.
+        if (!stopOnEqual && !df && count > 1 && !memcmp(srcPtr, destPtr, (count - 1) * sizeof(T)))
+            index = count - 1;
+        for (; index < count - 1; ++index) {
+            bool equal = *reinterpret_cast<const T*>(stringElement<T>(srcPtr, index, df)) == *reinterpret_cast<const T*>(stringElement<T>(destPtr, index, df));
+            if (equal == stopOnEqual)
+                break;
+        }
+        DT src = *reinterpret_cast<const T*>(stringElement<T>(srcPtr, index, df));
+        DT dest = *reinterpret_cast<const T*>(stringElement<T>(destPtr, index, df));
+        count = index + 1;
+        stepRegisterForAddressSize(RegisterSI, count * sizeof(T));
+        stepRegisterForAddressSize(RegisterDI, count * sizeof(T));
+        cmpFlags<T>(src - dest, src, dest);
+        return count;
     });
 }
 
@@ -87,6 +154,30 @@ void CPU::doSCAS(Instruction& insn)
         DT dest = readMemory<T>(SegmentRegisterIndex::ES, readRegisterForAddressSize(RegisterDI));
         stepRegisterForAddressSize(RegisterDI, sizeof(T));
         cmpFlags<T>(readRegister<T>(RegisterAL) - dest, readRegister<T>(RegisterAL), dest);
+    }, [this, &insn] (DWORD count) -> DWORD {
+        auto* destPtr = hostPointerForStringChunk<T>(SegmentRegisterIndex::ES, readRegisterForAddressSize(RegisterDI), count, MemoryAccessType::Read);
+        if (!destPtr)
+            return 0;
+        bool df = getDF();
+        bool stopOnEqual = insn.repPrefix() == Prefix::REPNZ;
+        T value = readRegister<T>(RegisterAL);
+        DWORD index = 0;
+        if constexpr (sizeof(T) == 1) {
+            if (stopOnEqual && !df) {
+                auto* match = static_cast<const BYTE*>(memchr(destPtr, value, count));
+                index = match ? match - destPtr : count - 1;
+            }
+        }
+        for (; index < count - 1; ++index) {
+            bool equal = *reinterpret_cast<const T*>(stringElement<T>(destPtr, index, df)) == value;
+            if (equal == stopOnEqual)
+                break;
+        }
+        DT dest = *reinterpret_cast<const T*>(stringElement<T>(destPtr, index, df));
+        count = index + 1;
+        stepRegisterForAddressSize(RegisterDI, count * sizeof(T));
+        cmpFlags<T>(value - dest, value, dest);
+        return count;
     });
 }
 
@@ -98,6 +189,33 @@ void CPU::doMOVS(Instruction& insn)
         writeMemory<T>(SegmentRegisterIndex::ES, readRegisterForAddressSize(RegisterDI), tmp);
         stepRegisterForAddressSize(RegisterSI, sizeof(T));
         stepRegisterForAddressSize(RegisterDI, sizeof(T));
+    }, [this] (DWORD count) -> DWORD {
+        auto* src = hostPointerForStringChunk<T>(currentSegment(), readRegisterForAddressSize(RegisterSI), count, MemoryAccessType::Read);
+        if (!src)
+            return 0;
+        auto* dest = hostPointerForStringChunk<T>(SegmentRegisterIndex::ES, readRegisterForAddressSize(RegisterDI), count, MemoryAccessType::Write);
+        if (!dest)
+            return 0;
+        bool df = getDF();
+        size_t size = count * sizeof(T);
+        BYTE* srcLow = df ? stringElement<T>(src, count - 1, true) : src;
+        BYTE* destLow = df ? stringElement<T>(dest, count - 1, true) : dest;
+        // memmove() matches element-by-element copying unless the destination trails the source
+        // in the direction of the copy, in which case earlier stores feed later loads.
+        bool overlaps = destLow < srcLow + size && srcLow < destLow + size;
+        if (!overlaps || (df ? dest >= src : dest <= src)) {
+            memmove(destLow, srcLow, size);
+        } else {
+            // Elements may overlap each other when the pointers are less than sizeof(T) apart.
+            for (DWORD i = 0; i < count; ++i) {
+                T data;
+                memcpy(&data, stringElement<T>(src, i, df), sizeof(T));
+                memcpy(stringElement<T>(dest, i, df), &data, sizeof(T));
+            }
+        }
+        stepRegisterForAddressSize(RegisterSI, size);
+        stepRegisterForAddressSize(RegisterDI, size);
+        return count;
     });
 }
 